@@ -5,17 +5,66 @@
 
 // This file contains the implementation of the main EDS algorithm.
 
+#include <thread>
+#include <atomic>
+
+// minimum window sum of one resource type over a range of steps (the leftmost step on ties),
+// an iterative segment tree over w[t] = N_r(t) + N_r(t+1) + ... + N_r(t+len-1)
+// the leaves keep (w[t] << 32 | t), so that the minimum also gives the leftmost step
+struct WindowMinTree
+{
+	int n = 0, len = 1, type = 0;
+	vector<long long> tree;
+	long long leaf(const StepTable& nrt,int t) const
+	{
+		long long sum = 0;
+		for (int d = 0; d < len && t + d < n; ++d)
+			sum += nrt[t+d][type];
+		return (sum << 32) | t;
+	}
+	void build(const StepTable& nrt,int _type,int _len)
+	{
+		n = nrt.size();
+		type = _type;
+		len = _len;
+		tree.assign(2 * n,0);
+		for (int t = 0; t < n; ++t)
+			tree[n+t] = leaf(nrt,t);
+		for (int i = n - 1; i > 0; --i)
+			tree[i] = min(tree[2*i],tree[2*i+1]);
+	}
+	// N_r(t) has changed in [a,b], so have the windows starting in [a-len+1,b]
+	void update(const StepTable& nrt,int a,int b)
+	{
+		for (int t = max(0,a - len + 1); t <= b && t < n; ++t)
+		{
+			tree[n+t] = leaf(nrt,t);
+			for (int i = (n + t) >> 1; i > 0; i >>= 1)
+				tree[i] = min(tree[2*i],tree[2*i+1]);
+		}
+	}
+	// the step in [a,b] with the least window sum
+	int query(int a,int b) const
+	{
+		long long res = tree[n+a];
+		for (int l = n + a, r = n + b + 1; l < r; l >>= 1, r >>= 1)
+		{
+			if (l & 1)
+				res = min(res,tree[l++]);
+			if (r & 1)
+				res = min(res,tree[--r]);
+		}
+		return (int)(res & 0xffffffff);
+	}
+};
+
 void graph::TC_EDS(int order_mode)
 {
 	print("Begin EDS...\n");
 	auto t1 = Clock::now();
 	topologicalSortingDFS(order_mode);
 	// initialize N_r(t)
-	map<string,int> temp;
-	for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-		temp[pnr->first] = 0;
-	for (int i = 0; i <= ConstrainedLatency; ++i) // number+1
-		nrt.push_back(temp);
+	nrt.assign(ConstrainedLatency+1,typeNum); // number+1
 
 	// placing operations on critical path
 	placeCriticalPath();
@@ -23,32 +72,24 @@ void graph::TC_EDS(int order_mode)
 	// cout << "Constrained latency: " << ConstrainedLatency << endl;
 
 	// main part of scheduling
+	// the least occupied window of each op is found in logarithmic time,
+	// all the ops of a type have the same delay, which is the window length
+	vector<WindowMinTree> window(typeNum);
+	for (int r = 0; r < typeNum; ++r)
+		window[r].build(nrt,r,r_delay[r]);
 	for (auto pnode = edsOrder.cbegin(); pnode != edsOrder.cend(); ++pnode)
 	{
-		int a = (*pnode)->asap, b = (*pnode)->alap;
+		int a = (*pnode)->asap(), b = (*pnode)->alap();
 		// because of topo order, it's pred must have been scheduled
-		double minnrt = MAXINT_;
-		int minstep = a, maxnrt = -MAXINT_, maxstep = a, flag = 0;
-		for (int t = a; t <= b; ++t)
-		{
-			double sumNrt = 0;
-			for (int d = 1; d <= (*pnode)->delay; ++d)
-			{
-				string tempType = mapResourceType((*pnode)->type);
-				sumNrt += nrt[t+d-1][tempType];
-			}
-			if (sumNrt < minnrt) // leave freedom to remained ops
-			{
-				minnrt = sumNrt;
-				minstep = t;
-			}
-		}
+		int minstep = (a <= b ? window[(*pnode)->rtype].query(a,b) : a); // leave freedom to remained ops
 		// cout << (*pnode)->num+1 << " (" << (*pnode)->name << "): " << a << " " << b << " Step: " << minstep << endl;
 		scheduleNodeStep(*pnode,minstep);
+		window[(*pnode)->rtype].update(nrt,minstep,minstep + (*pnode)->delay() - 1);
 	}
 	auto t2 = Clock::now();
 	print("Finish EDS!\n");
-	cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+	if (!QUIET)
+		cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
 }
 
 void graph::TC_IEDS(int order_mode)
@@ -57,28 +98,16 @@ void graph::TC_IEDS(int order_mode)
 	auto t1 = Clock::now();
 	topologicalSortingDFS(order_mode);
 	// initialize N_r(t)
-	map<string,int> temp;
-	for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-		temp[pnr->first] = 0;
-	for (int i = 0; i <= ConstrainedLatency; ++i) // number+1
-		nrt.push_back(temp);
+	nrt.assign(ConstrainedLatency+1,typeNum); // number+1
 
 	// build distribution graph
-	map<string,vector<double>> DG;// type step dg
-	for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-	{
-		vector<double> temp(ConstrainedLatency + MUL_DELAY,0);
-		DG[mapResourceType(pnr->first)] = temp;
-	}
-	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
-		for (int i = (*pnode)->asap; i <= (*pnode)->alap; ++i)
-			for (int d = 0; d < (*pnode)->delay; ++d)
-				DG[mapResourceType((*pnode)->type)][i + d] += 1.0 / (double)((*pnode)->getLength());
+	vector<vector<double>> DG;// type step dg
+	buildDG(DG);
 	double sum = 0;
 	for (int i = 1; i <= ConstrainedLatency; ++i)
 	{
-		for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-			sum += DG[pnr->first][i];
+		for (int r = 0; r < typeNum; ++r)
+			sum += DG[r][i];
 		if (sum > (float)vertex/2)
 		{
 			cout << "Mid line: " << i << endl;
@@ -95,23 +124,23 @@ void graph::TC_IEDS(int order_mode)
 	// main part of scheduling
 	// first set virtual constrained resource numbers
 	countTF();
-	map<string,vector<int>> gr;
-	for (auto pnr = nr.crbegin(); pnr != nr.crend(); ++pnr)
+	vector<vector<int>> gr(typeNum);
+	for (int r = typeNum - 1; r >= 0; --r)
 	{
-		int totnr = pnr->second * r_delay[pnr->first];
+		int totnr = nr[r] * r_delay[r];
 		int l = ConstrainedLatency;
 		int num = (totnr % l == 0 ? totnr / l : totnr / l + 1); // ceiling function
 		int q = totnr - l * (num - 1);
 		vector<int> n(ConstrainedLatency+1,0);
 		vector<bool> mark(ConstrainedLatency+1,false);
-		// cout << pnr->first << ": " << num << "*" << q << "+" << (num-1) << "*" << (l - q) << endl;
+		// cout << typeName[r] << ": " << num << "*" << q << "+" << (num-1) << "*" << (l - q) << endl;
 		for (int i = 1; i <= ConstrainedLatency; ++i)
 		{
-			if (TFcount[pnr->first][i] < num)
+			if (TFcount[r][i] < num)
 			{
-				totnr -= TFcount[pnr->first][i];
+				totnr -= TFcount[r][i];
 				l--; // reduce control step
-				n[i] = TFcount[pnr->first][i];
+				n[i] = TFcount[r][i];
 				mark[i] = true;
 			}
 		}
@@ -126,28 +155,26 @@ void graph::TC_IEDS(int order_mode)
 				}
 				else
 					n[i] = num - 1;
-		gr[pnr->first] = n;
-		// cout << pnr->first << ": ";
+		gr[r] = n;
+		// cout << typeName[r] << ": ";
 		// for (int i = 1; i <= ConstrainedLatency; ++i) // ConstrainedLatency
-		// 	cout << gr[pnr->first][i] << " ";
+		// 	cout << gr[r][i] << " ";
 		// cout << endl;
 	}
 
 	print("Begin placing other nodes...");
 	for (auto pnode = edsOrder.cbegin(); pnode != edsOrder.cend(); ++pnode)
 	{
-		int a = (*pnode)->asap, b = (*pnode)->alap;
+		int a = (*pnode)->asap(), b = (*pnode)->alap();
 		bool flag_out = false;
 		// cout << (*pnode)->name << " " << a << " " << b << endl;
 		for (int t = a; t <= b; ++t)
 		{
 			bool flag = true;
-			for (int d = 1; d <= (*pnode)->delay; ++d)
-			{
-				string tempType = mapResourceType((*pnode)->type);
-				if (nrt[t+d-1][tempType]+1 > gr[tempType][t+d-1])
+			int r = (*pnode)->rtype;
+			for (int d = 1; d <= (*pnode)->delay(); ++d)
+				if (nrt[t+d-1][r]+1 > gr[r][t+d-1])
 					flag = 0;
-			}
 			if (flag)
 			{
 				scheduleNodeStep(*pnode,t,2);
@@ -162,11 +189,8 @@ void graph::TC_IEDS(int order_mode)
 			for (int t = a; t <= b; ++t)
 			{
 				double sumNrt = 0;
-				for (int d = 1; d <= (*pnode)->delay; ++d)
-				{
-					string tempType = mapResourceType((*pnode)->type);
-					sumNrt += nrt[t+d-1][tempType];
-				}
+				for (int d = 1; d <= (*pnode)->delay(); ++d)
+					sumNrt += nrt[t+d-1][(*pnode)->rtype];
 				if (sumNrt < minnrt) // leave freedom to remained ops
 				{
 					minnrt = sumNrt;
@@ -178,94 +202,162 @@ void graph::TC_IEDS(int order_mode)
 	}
 	print("Placing other nodes done!\n");
 	print("Begin fine-tuning...\n");
-	int cnt = 0;
-	while (cnt != vertex)
-	{
-		cnt = 0;
-		for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); pnode++)
+	fineTuning();
+	auto t2 = Clock::now();
+	countEachStepResource();
+	print("Finish fine-tune.\n");
+	print("Finish IEDS!\n");
+	cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+}
+
+// fine-tuning of IEDS: an op is moved one step earlier (later) if that flattens N_r(t) of its type
+// the ops are swept in the order of adjlist until a sweep makes no move, as before,
+// but an op is only examined again if it may move now while it could not at its last examination:
+// - the N_r(t) condition of its type and start step turned true (see canMove below)
+// - it or one of its neighbours has been moved (testValid)
+// the other ops cannot move, so the result is the same as sweeping all the ops
+// it always terminates: an earlier move does not increase sum N_r(t)^2 and decreases the sum of the steps,
+// a later move decreases sum N_r(t)^2; moveBudget (if positive) bounds the number of moves in addition
+void graph::fineTuning()
+{
+	auto t1 = Clock::now();
+	int moves = 0, passes = 0;
+	// ops by type and start step (intrusive lists)
+	int steps = ConstrainedLatency + 2;
+	vector<int> head(steps * typeNum,-1), next(vertex,-1), prev(vertex,-1);
+	auto link = [&](int v)
+		{
+			int& h = head[adjlist[v]->cstep() * typeNum + adjlist[v]->rtype];
+			prev[v] = -1;
+			next[v] = h;
+			if (h != -1)
+				prev[h] = v;
+			h = v;
+		};
+	auto unlink = [&](int v)
 		{
-			// cout << (*pnode)-> num << " " << (*pnode)->cstep << " " << cnt << endl;
-			string tempType = mapResourceType((*pnode)->type);
-			int t = (*pnode)->cstep, cntin = 0;
-			for (int d = 1; d <= (*pnode)->delay; ++d)
-				if (t+d-2>0 && nrt[t+d-1][tempType] >= nrt[t+d-2][tempType] + 1)
+			if (prev[v] != -1)
+				next[prev[v]] = next[v];
+			else
+				head[adjlist[v]->cstep() * typeNum + adjlist[v]->rtype] = next[v];
+			if (next[v] != -1)
+				prev[next[v]] = prev[v];
+		};
+	for (int v = 0; v < vertex; ++v)
+		link(v);
+	// whether N_r(t) allows an op of type r starting at t to move earlier (bit 0) or later (bit 1)
+	// no op of the type starts after ConstrainedLatency - delay + 1 (N_r(t) has no row past ConstrainedLatency)
+	auto canMove = [this](int r,int t)
+		{
+			if (t + r_delay[r] - 1 > ConstrainedLatency)
+				return 0;
+			int res = 0, cntin = 0;
+			for (int d = 1; d <= r_delay[r]; ++d)
+				if (t+d-2>0 && nrt[t+d-1][r] >= nrt[t+d-2][r] + 1)
 					cntin++;
-			if (cntin == (*pnode)->delay)
-				if (t - 1 > 0 && (*pnode)->testValid(t-1)){
-					newScheduleNodeStep(*pnode,t-1);
-					continue;	
-				}
+			if (cntin == r_delay[r])
+				res |= 1;
 			cntin = 0;
-			for (int d = 1; d <= (*pnode)->delay; ++d)
-				if (t+d <= ConstrainedLatency && nrt[t+d-1][tempType] > nrt[t+d][tempType] + 1)
+			for (int d = 1; d <= r_delay[r]; ++d)
+				if (t+d <= ConstrainedLatency && nrt[t+d-1][r] > nrt[t+d][r] + 1)
 					cntin++;
-			if (cntin == (*pnode)->delay)
-				if (t + (*pnode)->delay - 1 <= ConstrainedLatency && (*pnode)->testValid(t+1)){
-					newScheduleNodeStep(*pnode,t+1);
+			if (cntin == r_delay[r])
+				res |= 2;
+			return res;
+		};
+	vector<char> cond(steps * typeNum,0);
+	for (int t = 1; t <= ConstrainedLatency; ++t)
+		for (int r = 0; r < typeNum; ++r)
+			cond[t * typeNum + r] = canMove(r,t);
+
+	// ops to examine in this sweep and in the next one (bitsets in the order of adjlist)
+	int words = (vertex + 63) / 64;
+	vector<uint64_t> current(words,~0ULL), later(words,0);
+	if (vertex % 64 != 0)
+		current[words-1] = (1ULL << (vertex % 64)) - 1;
+	int cursor = -1;
+	auto touch = [&](int u)
+		{
+			if (u > cursor) // not reached in this sweep yet
+				current[u >> 6] |= 1ULL << (u & 63);
+			else
+				later[u >> 6] |= 1ULL << (u & 63);
+		};
+
+	bool budget = true;
+	for (bool any = (vertex > 0); any && budget; )
+	{
+		passes++;
+		for (int w = 0; w < words && budget; ++w)
+			while (current[w] != 0)
+			{
+				if (moveBudget > 0 && moves >= moveBudget)
+				{
+					budget = false;
+					break;
+				}
+				cursor = (w << 6) + __builtin_ctzll(current[w]);
+				current[w] &= current[w] - 1;
+				VNode* node = adjlist[cursor];
+				int r = node->rtype;
+				int t = node->cstep(), step = t;
+				int c = cond[t * typeNum + r];
+				if ((c & 1) && t - 1 > 0 && node->testValid(t-1))
+					step = t - 1;
+				else if ((c & 2) && t + node->delay() - 1 <= ConstrainedLatency && node->testValid(t+1))
+					step = t + 1;
+				if (step == t)
 					continue;
+				unlink(cursor);
+				newScheduleNodeStep(node,step);
+				link(cursor);
+				moves++;
+				// N_r(t) has changed in [lo,hi], which is looked at by the ops of the type starting in [lo-delay,hi+1]
+				int lo = min(t,step), hi = max(t,step) + node->delay() - 1;
+				for (int i = max(1,lo - r_delay[r]); i <= min(ConstrainedLatency,hi + 1); ++i)
+				{
+					int before = cond[i * typeNum + r], after = canMove(r,i);
+					cond[i * typeNum + r] = after;
+					if (after & ~before)
+						for (int u = head[i * typeNum + r]; u != -1; u = next[u])
+							touch(u);
 				}
-			cnt++;
-		}
+				touch(cursor);
+				for (auto pnode = node->pred.cbegin(); pnode != node->pred.cend(); ++pnode)
+					touch((*pnode)->num);
+				for (auto pnode = node->succ.cbegin(); pnode != node->succ.cend(); ++pnode)
+					touch((*pnode)->num);
+			}
+		swap(current,later);
+		any = false;
+		for (int w = 0; w < words; ++w)
+			any |= (current[w] != 0);
+		cursor = -1;
 	}
 	auto t2 = Clock::now();
-	countEachStepResource();
-	print("Finish fine-tune.\n");
-	print("Finish IEDS!\n");
-	cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+	if (!budget)
+		print("Move budget (" + to_string(moveBudget) + ") reached!");
+	print("Fine-tuning: " + to_string(moves) + " moves in " + to_string(passes) + " passes, "
+		+ to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()) + " ns");
 }
 
-void graph::RC_EDS() // Resource-constrained EDS
+void graph::RC_EDS(int order_mode) // Resource-constrained EDS
 {
 	print("Begin EDS...\n");
 	auto t1 = Clock::now();
-	topologicalSortingDFS(0);
+	topologicalSortingDFS(order_mode);
 	// initialize N_r(t)
-	map<string,int> temp,maxNr;
-	for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-	{
-		temp[pnr->first] = 0;
-		maxNr[pnr->first] = MAXRESOURCE[pnr->first];
-	}
-	nrt.push_back(temp); // nrt[0]
+	vector<int> maxNr = resourceBound();
+	nrt.assign(1,typeNum); // nrt[0]
 
 	// NO nrt.push_back! NO placeCriticalPath!
 	print("Begin placing operations...");
-	for (auto pnode = order.cbegin(); pnode != order.cend(); ++pnode)
-	{
-		int a = (*pnode)->asap, b = (*pnode)->alap;
-		// because of topo order, it's pred must have been scheduled
-		int maxstep = a, maxnrt = -1;
-		// cout << (*pnode)->name << " " << a << " " << b << endl;
-		for (int t = a; t <= max(a,maxLatency) + MUL_DELAY; ++t)
-		{
-			int flag = 1, sumNrt = 0;
-			for (int d = 1; d <= (*pnode)->delay; ++d)
-			{
-				string tempType = mapResourceType((*pnode)->type);
-				if (t+d-1 >= nrt.size())
-					nrt.push_back(temp); // important!
-				if (nrt[t+d-1][tempType]+1 > maxNr[tempType])
-					flag = 0;
-				sumNrt += nrt[t+d-1][tempType];
-			}
-			// if (flag == 1)
-			// {
-			// 	maxstep = t;
-			// 	break;
-			// }
-			if (flag == 1 && sumNrt > maxnrt) // leave freedom to remained ops
-			{
-				maxnrt = sumNrt;
-				maxstep = t;
-				break;
-			}
-		}
-		scheduleNodeStepResource(*pnode,maxstep); // some differences
-	}
+	placeFirstFit(maxNr);
 	auto t2 = Clock::now();
 	print("Placing operations done!\n");
 	print("Finish EDS!\n");
-	cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+	if (!QUIET)
+		cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
 }
 
 void graph::RC_IEDS() // Resource-constrained EDS
@@ -274,52 +366,43 @@ void graph::RC_IEDS() // Resource-constrained EDS
 	auto t1 = Clock::now();
 	topologicalSortingDFS(1);
 	// initialize N_r(t)
-	map<string,int> temp,maxNr;
-	for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-	{
-		temp[pnr->first] = 0;
-		maxNr[pnr->first] = MAXRESOURCE[pnr->first];
-	}
-	nrt.push_back(temp); // nrt[0]
+	vector<int> maxNr = resourceBound();
+	nrt.assign(1,typeNum); // nrt[0]
 
 	// NO nrt.push_back! NO placeCriticalPath!
 	print("Begin placing operations...");
+	placeFirstFit(maxNr);
+	auto t2 = Clock::now();
+	print("Placing operations done!\n");
+	print("Finish IEDS!\n");
+	if (!QUIET)
+		cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+}
+
+// place the ops in order, each one at the first step from its ASAP where it fits under the resource constraints
+// (or at its ASAP if it cannot fit anywhere, i.e. the constraint of its type is 0)
+void graph::placeFirstFit(const vector<int>& maxNr)
+{
+	calendar.assign(typeNum);
 	for (auto pnode = order.cbegin(); pnode != order.cend(); ++pnode)
 	{
-		int a = (*pnode)->asap, b = (*pnode)->alap;
+		int a = (*pnode)->asap(), r = (*pnode)->rtype;
 		// because of topo order, it's pred must have been scheduled
-		int maxstep = a, maxnrt = -1;
-		// cout << (*pnode)->name << " " << a << " " << b << endl;
-		for (int t = a; t <= max(a,maxLatency) + MUL_DELAY; ++t)
-		{
-			int flag = 1, sumNrt = 0;
-			for (int d = 1; d <= (*pnode)->delay; ++d)
-			{
-				string tempType = mapResourceType((*pnode)->type);
-				if (t+d-1 >= nrt.size())
-					nrt.push_back(temp); // important!
-				if (nrt[t+d-1][tempType]+1 > maxNr[tempType])
-					flag = 0;
-				sumNrt += nrt[t+d-1][tempType];
-			}
-			// if (flag == 1)
-			// {
-			// 	maxstep = t;
-			// 	break;
-			// }
-			if (flag == 1 && sumNrt > maxnrt) // leave freedom to remained ops
-			{
-				maxnrt = sumNrt;
-				maxstep = t;
-				break;
-			}
-		}
-		scheduleNodeStepResource(*pnode,maxstep); // some differences
+		// (the steps after maxLatency are free, so the search ends by max(a,maxLatency+1))
+		int maxstep = (maxNr[r] > 0 ? calendar.firstFree(r,a,(*pnode)->delay()) : a);
+		bookResource(*pnode,maxstep,0,maxNr); // some differences
 	}
-	auto t2 = Clock::now();
-	print("Placing operations done!\n");
-	print("Finish IEDS!\n");
-	cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+}
+
+// schedule an op under the resource constraints, N_r(t) grows as needed and the steps that become full are marked
+void graph::bookResource(VNode* const& node,int step,int mode,const vector<int>& maxNr)
+{
+	int r = node->rtype;
+	while (step + node->delay() - 1 >= nrt.size())
+		nrt.push_back(); // important!
+	scheduleNodeStepResource(node,step,mode);
+	for (int i = step; i < step + node->delay(); ++i)
+		calendar.set(r,i,nrt[i][r] >= maxNr[r]);
 }
 
 void graph::placeCriticalPath()
@@ -327,22 +410,111 @@ void graph::placeCriticalPath()
 	print("Begin placing critical path...");
 	// int minL = MAXINT_;
 	// for (auto node : order)
-	// 	minL = min(minL,node->alap-node->asap);
+	// 	minL = min(minL,node->alap()-node->asap());
 	for (auto node : order)
 	{
-		if (node->asap == node->alap)
+		if (node->asap() == node->alap())
 		{
 			node->criticalPath = true;
-			scheduleNodeStep(node,node->asap);
+			scheduleNodeStep(node,node->asap());
 		}
 		else
 			edsOrder.push_back(node);
-		// if (node->alap - node->asap == minL)
+		// if (node->alap() - node->asap() == minL)
 		// 	node->criticalPath = true;
-		// if (node->asap == node->alap)
-		// 	scheduleNodeStep(node,node->asap,2);
+		// if (node->asap() == node->alap())
+		// 	scheduleNodeStep(node,node->asap(),2);
 		// else
 		// 	edsOrder.push_back(node);
 	}
 	print("Placing critical path done!");
-}
\ No newline at end of file
+}
+
+// multi-start EDS: portfolioSize variants are scheduled concurrently on copies of the graph (a pool of threads,
+// 0 for all the cores), and the best schedule is kept, i.e. the least total resources (TC) or the least latency (RC),
+// ties go to the smaller variant
+// variant i:	bit 0 top-down (0) or bottom-up (1)
+//				i >> 1 the order: 0 DFS, 1 ALAP-sorted, 2 ASAP-sorted (order_mode of topologicalSortingDFS),
+//				from 3 on ALAP-sorted and ASAP-sorted in turn with random tie-breaks seeded by seed and i,
+//				so the result is reproducible
+// the winner is scheduled again on this graph, so the output is the same as running that variant alone
+// (the graph keeps the winner's direction, see setPortfolio)
+void graph::portfolioEDS(int threads)
+{
+	print("Begin EDS portfolio...\n");
+	auto t1 = Clock::now();
+	bool rc = (MODE[0] >= 10);
+	int variants = max(1,portfolioSize);
+	if (threads <= 0)
+		threads = max(1,(int)std::thread::hardware_concurrency());
+	threads = min(threads,variants);
+	auto topdown = [](int i) { return (i & 1) == 0; };
+	auto orderMode = [](int i) { return (i >> 1) < 3 ? (i >> 1) : 2 - ((i >> 1) & 1); };
+	auto tie = [this](int i) -> unsigned
+		{
+			if ((i >> 1) < 3)
+				return 0;
+			unsigned s = seed * 2654435761u + (unsigned)i;
+			return (s == 0 ? 1 : s);
+		};
+
+	// (resources, latency) for TC, (latency, resources) for RC
+	vector<pair<int,int>> score(variants);
+	atomic<int> next(0);
+	auto worker = [&]()
+		{
+			for (int i = next++; i < variants; i = next++)
+			{
+				graph g(*this,topdown(i) != isTopDown()); // only reads this graph
+				g.PRINT = false;
+				g.QUIET = true;
+				g.tieSeed = tie(i);
+				g.resetSchedule();
+				if (rc)
+					g.RC_EDS(orderMode(i));
+				else
+					g.TC_EDS(orderMode(i));
+				int sum_r = 0;
+				for (int r = 0; r < typeNum; ++r)
+					sum_r += g.nrt.peak[r];
+				score[i] = (rc ? make_pair(g.maxLatency,sum_r) : make_pair(sum_r,g.maxLatency));
+			}
+		};
+	vector<std::thread> pool;
+	for (int k = 1; k < threads; ++k)
+		pool.emplace_back(worker);
+	worker();
+	for (auto& th : pool)
+		th.join();
+
+	int best = 0;
+	for (int i = 0; i < variants; ++i)
+	{
+		print("Variant " + to_string(i) + (topdown(i) ? " (top-down, " : " (bottom-up, ")
+			+ (orderMode(i) == 0 ? "DFS order" : orderMode(i) == 1 ? "ALAP order" : "ASAP order")
+			+ (tie(i) ? ", random ties seed " + to_string(tie(i)) : "") + "): "
+			+ (rc ? "latency " + to_string(score[i].first) + ", resources " + to_string(score[i].second)
+				: "resources " + to_string(score[i].first) + ", latency " + to_string(score[i].second)));
+		if (score[i] < score[best])
+			best = i;
+	}
+	print("Best variant: " + to_string(best) + "\n");
+
+	// schedule the winner on this graph
+	if (topdown(best) != isTopDown())
+		reverseEdges();
+	resetSchedule();
+	tieSeed = tie(best);
+	bool quiet = QUIET;
+	QUIET = true;
+	if (rc)
+		RC_EDS(orderMode(best));
+	else
+		TC_EDS(orderMode(best));
+	QUIET = quiet;
+	tieSeed = 0;
+	auto t2 = Clock::now();
+	print("Finish EDS portfolio!\n");
+	if (!QUIET)
+		cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+}
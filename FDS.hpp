@@ -5,144 +5,654 @@
 
 // This file contains the implementation of the force-directed scheduling (FDS).
 
-double graph::calForce(int a,int b,int na,int nb,const vector<double>& DG,int delay) const // [a,b]->[na,nb]
+#include <functional>
+
+// persistent pool of threads for the force evaluations (LevelBarrier is in topological_sorting.hpp):
+// run(n,chunk,f) calls f(i,t) for every i in [0,n) on the thread t (0 .. threads-1) and returns when all are done
+// work-stealing: [0,n) is split into one range per thread, a thread takes chunks from the front of its own range,
+// and once it is empty it steals the back half of the largest range left, so the threads with cheap indices
+// take over the work of the others; a range is a packed atomic (lo,hi), changed by compare-and-swap only
+struct ForcePool
+{
+	int threads;
+	std::vector<std::thread> pool;
+	LevelBarrier start, finish;
+	std::function<void(int,int)> job;
+	int chunk = 1;
+	std::vector<std::atomic<uint64_t>> range; // lo << 32 | hi of every thread
+	bool quit = false;
+	ForcePool(int _threads): threads(max(1,_threads)), start(max(1,_threads)), finish(max(1,_threads)), range(max(1,_threads))
+	{
+		for (int t = 1; t < threads; ++t)
+			pool.emplace_back([this,t]
+				{
+					for (start.wait(); !quit; start.wait())
+					{
+						drain(t);
+						finish.wait();
+					}
+				});
+	}
+	~ForcePool()
+	{
+		if (threads > 1)
+		{
+			quit = true;
+			start.wait();
+		}
+		for (auto& th : pool)
+			th.join();
+	}
+	static inline uint64_t pack(int lo,int hi) { return ((uint64_t)(uint32_t)lo << 32) | (uint32_t)hi; }
+	// the next chunk [lo,hi) of the range of t, false if it is empty
+	bool take(int t,int& lo,int& hi)
+	{
+		uint64_t r = range[t].load();
+		while ((int)(r >> 32) < (int)(uint32_t)r)
+		{
+			lo = r >> 32;
+			hi = min((int)(uint32_t)r,lo + chunk);
+			if (range[t].compare_exchange_weak(r,pack(hi,(int)(uint32_t)r)))
+				return true;
+		}
+		return false;
+	}
+	// move the back half of the largest range of another thread to the range of t, false if all are empty
+	bool steal(int t)
+	{
+		for (;;)
+		{
+			int victim = -1, most = 0;
+			for (int v = 0; v < threads; ++v)
+			{
+				uint64_t r = range[v].load();
+				if (v != t && (int)(uint32_t)r - (int)(r >> 32) > most)
+				{
+					victim = v;
+					most = (int)(uint32_t)r - (int)(r >> 32);
+				}
+			}
+			if (victim == -1)
+				return false;
+			uint64_t r = range[victim].load();
+			int lo = r >> 32, hi = (uint32_t)r, mid = lo + (hi - lo) / 2;
+			if (lo < hi && range[victim].compare_exchange_strong(r,pack(lo,mid)))
+			{
+				range[t].store(pack(mid,hi));
+				return true;
+			}
+		}
+	}
+	void drain(int t)
+	{
+		int lo, hi;
+		for (;;)
+			if (take(t,lo,hi))
+				for (int i = lo; i < hi; ++i)
+					job(i,t);
+			else if (!steal(t))
+				return;
+	}
+	void run(int n,int _chunk,const std::function<void(int,int)>& f)
+	{
+		if (threads == 1)
+		{
+			for (int i = 0; i < n; ++i)
+				f(i,0);
+			return;
+		}
+		job = f;
+		chunk = max(1,_chunk);
+		for (int t = 0; t < threads; ++t)
+			range[t].store(pack((int)((long long)n * t / threads),(int)((long long)n * (t + 1) / threads)));
+		start.wait();
+		drain(0);
+		finish.wait();
+	}
+};
+
+// the time frames [ASAP, ALAP+delay-1] of the unscheduled ops of one type, to find the ones that intersect
+// a range of steps without scanning them all: a segment tree over the ops (in order of their first ASAP)
+// with the least start and the greatest end of every subtree, so the subtrees out of the range are skipped
+struct FrameTree
+{
+	int size = 1;
+	std::vector<int> lo, hi; // least start and greatest end of a subtree (MAXINT_ and -1 if it is empty)
+	std::vector<int> op; // the op of every leaf
+	// the leaves are the ops in order, their frames are set with set() and then build()
+	void assign(const std::vector<int>& ops)
+	{
+		for (size = 1; size < (int)ops.size(); size <<= 1);
+		lo.assign(2 * size,MAXINT_);
+		hi.assign(2 * size,-1);
+		op = ops;
+	}
+	inline void set(int leaf,int start,int end) { lo[leaf + size] = start; hi[leaf + size] = end; }
+	void build()
+	{
+		for (int i = size - 1; i > 0; --i)
+		{
+			lo[i] = min(lo[2*i],lo[2*i+1]);
+			hi[i] = max(hi[2*i],hi[2*i+1]);
+		}
+	}
+	// change the frame of a leaf (MAXINT_, -1 to remove it)
+	void update(int leaf,int start,int end)
+	{
+		int i = leaf + size;
+		lo[i] = start;
+		hi[i] = end;
+		for (i >>= 1; i > 0; i >>= 1)
+		{
+			lo[i] = min(lo[2*i],lo[2*i+1]);
+			hi[i] = max(hi[2*i],hi[2*i+1]);
+		}
+	}
+	// f(op) for every op whose frame intersects [a,b]
+	template <class F> void query(int a,int b,const F& f,int i = 1) const
+	{
+		if (lo[i] > b || hi[i] < a)
+			return;
+		if (i >= size)
+			f(op[i - size]);
+		else
+		{
+			query(a,b,f,2*i);
+			query(a,b,f,2*i+1);
+		}
+	}
+};
+
+// DGsum is the prefix sum of a row of DG (see prefixDG), so the sums over the ranges are O(1)
+double graph::calForce(int a,int b,int na,int nb,const vector<double>& DGsum,int delay) const // [a,b]->[na,nb]
 {
 	if ((na > nb) || (a > b))
 		return 0;
 	double res = 0, sum = 0;
-	for (int i = na; i <= nb+delay-1; ++i)
-		sum += DG[i];
+	sum = DGsum[nb+delay] - DGsum[na]; // DG[na .. nb+delay-1]
 	res += sum/(double)(nb-na+1);
 	res += (double)(nb-na)/(double)(3*(nb-na+1)); // look-ahead: temp_DG[i]=DG[i]+x(i)/3 => (h-1)^2/(3h^2)+\sum 1/(3h^2)=(h-1)/(3h)
-	sum = 0;
-	for (int i = a; i <= b+delay-1; ++i)
-		sum += DG[i];
+	sum = DGsum[b+delay] - DGsum[a]; // DG[a .. b+delay-1]
 	res -= sum/(double)(b-a+1);
 	res -= (double)(b-a)/(double)(3*(b-a+1)); // look-ahead
 	return res;
 }
 
-double graph::calSuccForce(VNode* const& v,int cstep,const map<string,vector<double>>& DG) const
+// add (sign = 1) or remove (sign = -1) the contribution of v with the time frame [a,b] to DG
+void graph::addDG(vector<vector<double>>& DG,int v,int a,int b,double sign) const
+{
+	double p = sign / (double)(b - a + 1);
+	double* dg = DG[adjlist[v]->rtype].data();
+	for (int i = a; i <= b; ++i)
+		for (int d = 0; d < ns.delay[v]; ++d)
+			dg[i + d] += p;
+}
+
+// debug: compare an incrementally maintained DG against a full rebuild
+void graph::checkDG(const vector<vector<double>>& DG) const
+{
+	vector<vector<double>> fullDG;
+	buildDG(fullDG);
+	for (int r = 0; r < typeNum; ++r)
+		for (size_t i = 0; i < DG[r].size(); ++i)
+		{
+			double full = (i < fullDG[r].size() ? fullDG[r][i] : 0);
+			if (fabs(full - DG[r][i]) > 1e-9)
+				cout << "DG mismatch: " << typeName[r] << " step " << i << ": " << DG[r][i]
+					<< " (incremental) vs " << full << " (rebuilt)" << endl;
+		}
+}
+
+// DGsum[r][i] = DG[r][0] + ... + DG[r][i-1]
+void graph::prefixDG(const vector<vector<double>>& DG,vector<vector<double>>& DGsum) const
+{
+	DGsum.resize(DG.size());
+	for (size_t r = 0; r < DG.size(); ++r)
+	{
+		DGsum[r].resize(DG[r].size() + 1);
+		DGsum[r][0] = 0;
+		for (size_t i = 0; i < DG[r].size(); ++i)
+			DGsum[r][i+1] = DGsum[r][i] + DG[r][i];
+	}
+}
+
+// DG has changed, the memoized forces are out of date
+// (the table is reallocated if the latency has changed, e.g. extended by RC_FDS)
+void graph::newForceVersion()
+{
+	int width = ConstrainedLatency + 2;
+	if (width != memoWidth || forceStamp.size() != (size_t)vertex * 2 * width)
+	{
+		memoWidth = width;
+		vector<atomic<double>>((size_t)vertex * 2 * width).swap(forceMemo);
+		vector<atomic<int>>((size_t)vertex * 2 * width).swap(forceStamp);
+		for (auto& stamp : forceStamp)
+			stamp.store(0,memory_order_relaxed);
+		dgVersion = 0;
+	}
+	dgVersion++;
+}
+
+// build distribution graph
+// the time frames are read from the parallel arrays, so the pass is linear in memory
+void graph::buildDG(vector<vector<double>>& DG) const
+{
+	DG.assign(typeNum,vector<double>(ConstrainedLatency + MUL_DELAY,0));
+	vector<double*> row(vertex); // DG row of each node, looked up only once
+	for (int v = 0; v < vertex; ++v)
+		row[v] = DG[adjlist[v]->rtype].data();
+	const int* asap = ns.asap.data();
+	const int* alap = ns.alap.data();
+	const int* delay = ns.delay.data();
+	for (int v = 0; v < vertex; ++v)
+	{
+		double p = 1.0 / (double)(alap[v] - asap[v] + 1);
+		double* dg = row[v];
+		for (int i = asap[v]; i <= alap[v]; ++i)
+			for (int d = 0; d < delay[v]; ++d)
+				dg[i + d] += p;
+	}
+}
+
+// the forces on the successors (predecessors) of v if it is placed at cstep, memoized for the current DG
+double graph::calSuccForce(VNode* const& v,int cstep,const vector<vector<double>>& DGsum)
 {
+	bool memo = (cstep >= 0 && cstep < memoWidth);
+	size_t key = ((size_t)v->num * 2) * memoWidth + cstep;
+	if (memo && forceStamp[key].load(memory_order_acquire) == dgVersion)
+		return forceMemo[key].load(memory_order_relaxed);
 	double f = 0;
 	for (auto pnode = v->succ.cbegin(); pnode != v->succ.cend(); ++pnode)
-		if (mapResourceType((*pnode)->type) == mapResourceType(v->type) && (*pnode)->asap <= cstep && (*pnode)->alap >= cstep) // type should be same
+		if ((*pnode)->rtype == v->rtype && (*pnode)->asap() <= cstep && (*pnode)->alap() >= cstep) // type should be same
 		{
-			f += calForce((*pnode)->asap,(*pnode)->alap,cstep+1,(*pnode)->alap,
-					DG.at(mapResourceType((*pnode)->type)),(*pnode)->delay);
-			if (cstep + 1 == (*pnode)->alap) // recursion
+			f += calForce((*pnode)->asap(),(*pnode)->alap(),cstep+1,(*pnode)->alap(),
+					DGsum[(*pnode)->rtype],(*pnode)->delay());
+			if (cstep + 1 == (*pnode)->alap()) // recursion
 			{
-				f += calForce((*pnode)->asap,(*pnode)->alap,cstep+1,cstep+1,DG.at(mapResourceType((*pnode)->type)),(*pnode)->delay);
-				f += calSuccForce((*pnode),cstep+1,DG);
-				f += calPredForce((*pnode),cstep+1,DG);
+				f += calForce((*pnode)->asap(),(*pnode)->alap(),cstep+1,cstep+1,DGsum[(*pnode)->rtype],(*pnode)->delay());
+				f += calSuccForce((*pnode),cstep+1,DGsum);
+				f += calPredForce((*pnode),cstep+1,DGsum);
 			}
 		}
+	if (memo)
+	{
+		forceMemo[key].store(f,memory_order_relaxed);
+		forceStamp[key].store(dgVersion,memory_order_release);
+	}
 	return f;
 }
 
-double graph::calPredForce(VNode* const& v,int cstep,const map<string,vector<double>>& DG) const
+double graph::calPredForce(VNode* const& v,int cstep,const vector<vector<double>>& DGsum)
 {
+	bool memo = (cstep >= 0 && cstep < memoWidth);
+	size_t key = ((size_t)v->num * 2 + 1) * memoWidth + cstep;
+	if (memo && forceStamp[key].load(memory_order_acquire) == dgVersion)
+		return forceMemo[key].load(memory_order_relaxed);
 	double f = 0;
 	for (auto pnode = v->pred.cbegin(); pnode != v->pred.cend(); ++pnode)
-		if (mapResourceType((*pnode)->type) == mapResourceType(v->type) && (*pnode)->asap <= cstep && (*pnode)->alap >= cstep)
+		if ((*pnode)->rtype == v->rtype && (*pnode)->asap() <= cstep && (*pnode)->alap() >= cstep)
 		{
-			f += calForce((*pnode)->asap,(*pnode)->alap,(*pnode)->asap,cstep-1,
-					DG.at(mapResourceType((*pnode)->type)),(*pnode)->delay);
-			if (cstep - 1 == (*pnode)->asap)
+			f += calForce((*pnode)->asap(),(*pnode)->alap(),(*pnode)->asap(),cstep-1,
+					DGsum[(*pnode)->rtype],(*pnode)->delay());
+			if (cstep - 1 == (*pnode)->asap())
 			{
-				f += calForce((*pnode)->asap,(*pnode)->alap,cstep-1,cstep-1,DG.at(mapResourceType((*pnode)->type)),(*pnode)->delay);
-				f += calSuccForce((*pnode),cstep-1,DG);
-				f += calPredForce((*pnode),cstep-1,DG);
+				f += calForce((*pnode)->asap(),(*pnode)->alap(),cstep-1,cstep-1,DGsum[(*pnode)->rtype],(*pnode)->delay());
+				f += calSuccForce((*pnode),cstep-1,DGsum);
+				f += calPredForce((*pnode),cstep-1,DGsum);
 			}
 		}
+	if (memo)
+	{
+		forceMemo[key].store(f,memory_order_relaxed);
+		forceStamp[key].store(dgVersion,memory_order_release);
+	}
 	return f;
 }
 
-void graph::TC_FDS() // Time-constrained Force-Directed Scheduling
+// self force of v placed at cstep, plus the forces on its neighbours
+double graph::calTotalForce(VNode* const& v,int cstep,const vector<vector<double>>& DGsum)
+{
+	double f = calForce(v->asap(),v->alap(),cstep,cstep,DGsum[v->rtype],v->delay());
+	f += calSuccForce(v,cstep,DGsum);
+	f += calPredForce(v,cstep,DGsum);
+	return f;
+}
+
+bool graph::TC_FDS(int threads) // Time-constrained Force-Directed Scheduling
 {
 	print("Begin time-constrained force-directed scheduling (FDS)...\n");
 	auto t1 = Clock::now();
 	topologicalSortingDFS();
 	// initialize N_r(t)
-	map<string,int> temp;
-	for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-		temp[pnr->first] = 0;
-	for (int i = 0; i <= ConstrainedLatency; ++i) // number+1
-		nrt.push_back(temp);
+	nrt.assign(ConstrainedLatency+1,typeNum); // number+1
 
 	print("Begin placing operations...");
 	clearMark();
+	// distribution graph, built once and then kept up to date:
+	// after a placement, only the ops whose time frame has been tightened by scheduleAll
+	// have their old 1/length contribution subtracted and the new one added
+	vector<vector<double>> DG;// type step dg
+	buildDG(DG);
+	vector<int> dgASAP(ns.asap), dgALAP(ns.alap); // the time frames DG is made of
+	vector<vector<double>> DGsum;
+	prefixDG(DG,DGsum);
+	newForceVersion();
+	trackFrames = true;
+	tightened.clear();
+	if (threads <= 0)
+		threads = max(1,(int)std::thread::hardware_concurrency());
+	ForcePool pool(threads);
+
+	// the best candidate (step) of every unscheduled op in a min-heap on its exact force, ties to the smaller op and step
+	// (the top is then the best of all the candidates (op, step))
+	// an entry is tagged with the version of its op when it was scored, the version of an op is bumped
+	// when its force may have changed, i.e. the time frame of the op or of a neighbour of the same type
+	// has been tightened, or DG of its type (or of such a neighbour) has changed over its time frame
+	// the bumped ops are scored again right away (eager) and their old entries are dropped when they come up,
+	// so the top of the heap is always the exact minimum, and a placement costs the re-scoring of the bumped ops
+	// (scoring them only when popped stale would need the old forces to be lower bounds of the new ones,
+	// but a force drops as well as rises when DG changes, so a stale entry could hide a better candidate)
+	// the bumped ops are found through the frames of their type (FrameTree), not by a scan of the unscheduled ops
+	struct Candidate
+	{
+		double force;
+		int op, step, version;
+		bool operator>(const Candidate& c) const { return make_tuple(force,op,step) > make_tuple(c.force,c.op,c.step); }
+	};
+	vector<Candidate> heap;
+	auto later = greater<Candidate>();
+	vector<int> version(vertex,0);
+	vector<vector<int>> banned(vertex); // the infeasible steps of every op
+	// the best candidates of some ops, scored in parallel into a buffer per thread, and pushed
+	// (the minimum over the steps of an op is taken by the thread that scores it, the minimum over the ops is the heap top)
+	vector<vector<Candidate>> found(pool.threads);
+	auto score = [&](const vector<VNode*>& ops) -> long long
+		{
+			pool.run(ops.size(),4,[&](int k,int t)
+				{
+					VNode* node = ops[k];
+					const vector<int>& ban = banned[node->num];
+					Candidate b = {0,node->num,-1,version[node->num]};
+					for (int i = node->asap(); i <= node->alap(); ++i)
+						if (ban.empty() || find(ban.begin(),ban.end(),i) == ban.end())
+						{
+							double f = calTotalForce(node,i,DGsum);
+							if (b.step == -1 || f < b.force)
+							{
+								b.force = f;
+								b.step = i;
+							}
+						}
+					if (b.step != -1)
+						found[t].push_back(b);
+				});
+			for (auto& buffer : found)
+			{
+				for (auto& b : buffer)
+				{
+					heap.push_back(b);
+					push_heap(heap.begin(),heap.end(),later);
+				}
+				buffer.clear();
+			}
+			long long n = 0;
+			for (auto node : ops)
+				n += node->alap() - node->asap() + 1;
+			return n;
+		};
+	// the unscheduled ops of every type (pos is the index in its list), and their time frames (leaf in the tree)
+	vector<vector<VNode*>> pending(typeNum);
+	vector<int> pos(vertex);
+	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
+	{
+		pos[(*pnode)->num] = pending[(*pnode)->rtype].size();
+		pending[(*pnode)->rtype].push_back(*pnode);
+	}
+	vector<FrameTree> frames(typeNum);
+	vector<int> leaf(vertex);
+	for (int r = 0; r < typeNum; ++r)
+	{
+		vector<int> byASAP;
+		for (auto node : pending[r])
+			byASAP.push_back(node->num);
+		stable_sort(byASAP.begin(),byASAP.end(),[this](int v1,int v2) { return ns.asap[v1] < ns.asap[v2]; });
+		frames[r].assign(byASAP);
+		for (size_t i = 0; i < byASAP.size(); ++i)
+		{
+			int v = byASAP[i];
+			leaf[v] = i;
+			frames[r].set(i,ns.asap[v],ns.alap[v] + ns.delay[v] - 1);
+		}
+		frames[r].build();
+	}
+	// score all the unscheduled ops (again)
+	vector<VNode*> ops;
+	auto fill = [&]()
+		{
+			ops.clear();
+			for (int r = 0; r < typeNum; ++r)
+				ops.insert(ops.end(),pending[r].begin(),pending[r].end());
+			heap.clear();
+			score(ops);
+		};
+	fill();
+	size_t compacted = heap.size();
+	vector<char> seen(vertex,0); // 1: its force inputs may have changed, 2: bumped
+	vector<int> changed; // the ops whose time frame or DG over it has changed
+	vector<vector<pair<int,int>>> dgChanged(typeNum); // ranges of steps of DG changed by the last placement, per type
+	long long rescored = 0;
+	bool refilled = false;
 	while (numScheduledOp < vertex)
 	{
-		double minF = MAXINT_;
-		int bestop = 0, beststep = 1;
-
-		// build distribution graph
-		map<string,vector<double>> DG;// type step dg
-		for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
+		// pop the op and step with lowest force
+		VNode* placed = nullptr;
+		while (!heap.empty() && placed == nullptr)
 		{
-			vector<double> temp(ConstrainedLatency + MUL_DELAY,0);
-			DG[mapResourceType(pnr->first)] = temp;
+			pop_heap(heap.begin(),heap.end(),later);
+			Candidate c = heap.back();
+			heap.pop_back();
+			VNode* node = adjlist[c.op];
+			if (node->cstep() != 0 || c.version != version[c.op]) // out of date
+				continue;
+			if (CHECK && fabs(c.force - calTotalForce(node,c.step,DGsum)) > 1e-9) // debug: the entries are exact
+				cout << "Force out of date: op " << c.op+1 << " step " << c.step << ": " << c.force
+					<< " vs " << calTotalForce(node,c.step,DGsum) << endl;
+			if (CHECK) // debug: the top is the least force of all the candidates, as a full scan would find
+				for (auto other : adjlist)
+					if (other->cstep() == 0)
+						for (int i = other->asap(); i <= other->alap(); ++i)
+							if (find(banned[other->num].begin(),banned[other->num].end(),i) == banned[other->num].end()
+								&& calTotalForce(other,i,DGsum) < c.force - 1e-9)
+								cout << "Not the least force: op " << c.op+1 << " step " << c.step << ": " << c.force
+									<< " vs op " << other->num+1 << " step " << i << ": " << calTotalForce(other,i,DGsum) << endl;
+			if (scheduleNodeStep(node,c.step,2))
+				placed = node;
+			else // an infeasible candidate stays infeasible (time frames only shrink), the op falls back on its next best
+			{
+				banned[c.op].push_back(c.step);
+				version[c.op]++;
+				rescored += score(vector<VNode*>(1,node));
+			}
 		}
-		for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
-			for (int i = (*pnode)->asap; i <= (*pnode)->alap; ++i)
-				for (int d = 0; d < (*pnode)->delay; ++d)
-					DG[mapResourceType((*pnode)->type)][i + d] += 1.0 / (double)((*pnode)->getLength());
+		if (placed == nullptr) // no candidate left, score them all again, only once in a row
+		{
+			if (!refilled)
+			{
+				refilled = true;
+				fill();
+				compacted = heap.size();
+				if (!heap.empty())
+					continue;
+			}
+			cout << "No feasible placement!" << endl;
+			trackFrames = false;
+			return false;
+		}
+		refilled = false;
+		vector<VNode*>& list = pending[placed->rtype];
+		pos[list.back()->num] = pos[placed->num];
+		list[pos[placed->num]] = list.back();
+		list.pop_back();
+		frames[placed->rtype].update(leaf[placed->num],MAXINT_,-1);
 
-		// find the op and step with lowest force
-		vector<pair<int,pair<int,int>>> fv; // force, op, step
-		for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
+		// update distribution graph (a node may be listed more than once)
+		for (auto v : tightened)
+			if (ns.asap[v] != dgASAP[v] || ns.alap[v] != dgALAP[v])
+			{
+				int r = adjlist[v]->rtype;
+				dgChanged[r].push_back(make_pair(dgASAP[v],dgALAP[v] + ns.delay[v] - 1)); // the new frame is inside
+				addDG(DG,v,dgASAP[v],dgALAP[v],-1);
+				addDG(DG,v,ns.asap[v],ns.alap[v],1);
+				dgASAP[v] = ns.asap[v];
+				dgALAP[v] = ns.alap[v];
+				if (adjlist[v]->cstep() == 0)
+					frames[r].update(leaf[v],ns.asap[v],ns.alap[v] + ns.delay[v] - 1);
+				if (!seen[v])
+				{
+					seen[v] = 1;
+					changed.push_back(v);
+				}
+			}
+		tightened.clear();
+		prefixDG(DG,DGsum);
+		newForceVersion();
+		// the unscheduled ops of the types whose DG has changed over their time frame
+		for (int r = 0; r < typeNum; ++r)
 		{
-			if ((*pnode)->cstep != 0)
-				continue;
-			for (int i = (*pnode)->asap; i <= (*pnode)->alap; ++i)
+			// the overlapping ranges are merged, so an op is found at most once
+			sort(dgChanged[r].begin(),dgChanged[r].end());
+			for (size_t i = 0; i < dgChanged[r].size(); )
 			{
-				double f = calForce((*pnode)->asap, (*pnode)->alap, i, i, DG.at(mapResourceType((*pnode)->type)), (*pnode)->delay);
-				f += calSuccForce(*pnode, i, DG);
-				f += calPredForce(*pnode, i, DG);
-				pair<int,int> opstep = {(*pnode)->num,i};
-				pair<int,pair<int,int>> temp = {f,opstep};
-				fv.push_back(temp);
-				// if (f < minF)
-				// {
-				// 	minF = f;
-				// 	bestop = (*pnode)->num;
-				// 	beststep = i;
-				// }
+				int lo = dgChanged[r][i].first, hi = dgChanged[r][i].second;
+				for (++i; i < dgChanged[r].size() && dgChanged[r][i].first <= hi + 1; ++i)
+					hi = max(hi,dgChanged[r][i].second);
+				frames[r].query(lo,hi,[&](int v)
+					{
+						if (!seen[v])
+						{
+							seen[v] = 1;
+							changed.push_back(v);
+						}
+					});
 			}
+			dgChanged[r].clear();
+		}
+		// bump them and their unscheduled neighbours of the same type (see calSuccForce/calPredForce),
+		// and then the neighbours whose force recurses into a bumped op, i.e. that evaluate a successor u
+		// at the step before its ALAP (a predecessor at the step after its ASAP), both frames containing it
+		ops.clear();
+		auto bump = [&](VNode* const& node)
+			{
+				if (node->cstep() == 0 && seen[node->num] != 2)
+				{
+					seen[node->num] = 2;
+					version[node->num]++;
+					ops.push_back(node);
+				}
+			};
+		auto within = [](VNode* const& x,int c) { return x->asap() <= c && c <= x->alap(); };
+		for (size_t k = 0; k < changed.size(); ++k)
+		{
+			VNode* node = adjlist[changed[k]];
+			for (auto pnb = node->succ.cbegin(); pnb != node->succ.cend(); ++pnb)
+				if ((*pnb)->rtype == node->rtype)
+					bump(*pnb);
+			for (auto pnb = node->pred.cbegin(); pnb != node->pred.cend(); ++pnb)
+				if ((*pnb)->rtype == node->rtype)
+					bump(*pnb);
+			bump(node);
+		}
+		for (size_t k = 0; k < ops.size(); ++k)
+		{
+			VNode* u = ops[k];
+			for (auto px = u->pred.cbegin(); px != u->pred.cend(); ++px)
+				if ((*px)->rtype == u->rtype && within(*px,u->alap() - 1) && within(u,u->alap() - 1))
+					bump(*px);
+			for (auto px = u->succ.cbegin(); px != u->succ.cend(); ++px)
+				if ((*px)->rtype == u->rtype && within(*px,u->asap() + 1) && within(u,u->asap() + 1))
+					bump(*px);
+		}
+		rescored += score(ops);
+		for (auto v : changed)
+			seen[v] = 0;
+		for (auto node : ops)
+			seen[node->num] = 0;
+		changed.clear();
+		// drop the out-of-date entries once they outnumber the others
+		if (heap.size() > 2 * compacted + 1024)
+		{
+			heap.erase(remove_if(heap.begin(),heap.end(),[&](const Candidate& c)
+				{ return adjlist[c.op]->cstep() != 0 || c.version != version[c.op]; }),heap.end());
+			make_heap(heap.begin(),heap.end(),later);
+			compacted = heap.size();
 		}
-		std::sort(fv.begin(),fv.end(),
-				[](const pair<int,pair<int,int>>& f1, const pair<int,pair<int,int>>& f2) // lambda
-				{return f1.first < f2.first;});
-		for (auto node : fv)
-			if (scheduleNodeStep(adjlist[node.second.first],node.second.second,2))
-				break;
-		// scheduleNodeStep(adjlist[bestop],beststep,2);
+		if (CHECK)
+			checkDG(DG);
 	}
+	print("Candidates scored again: " + to_string(rescored));
+	trackFrames = false;
 	auto t2 = Clock::now();
 	print("Placing operations done!\n");
 	print("Finish force-directed scheduling!\n");
-	cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+	if (!QUIET)
+		cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+	return true;
 }
 
-void graph::RC_FDS() // Resource-constrained Force-Directed Scheduling
+void graph::RC_FDS(int threads) // Resource-constrained Force-Directed Scheduling
 {
 	print("Begin resource-constrained force-directed scheduling (FDS)...\n");
 	auto t1 = Clock::now();
 	topologicalSortingDFS();
 	// initialize N_r(t)
-	map<string,int> temp,maxNr;
-	for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-	{
-		temp[pnr->first] = 0;
-		maxNr[pnr->first] = MAXRESOURCE[pnr->first];
-	}
-	nrt.push_back(temp); // nrt[0]
+	vector<int> maxNr = resourceBound();
+	nrt.assign(1,typeNum); // nrt[0]
 
 	print("Begin placing operations...");
 	int cstep = 0;
 	vector<VNode*> readyList;
 	clearMark();
+	if (threads <= 0)
+		threads = max(1,(int)std::thread::hardware_concurrency());
+	ForcePool pool(threads);
+	vector<double> force(vertex,0);
+
+	// distribution graph, kept up to date as in TC_FDS
+	vector<vector<double>> DG;// type step dg
+	buildDG(DG);
+	vector<int> dgASAP(ns.asap), dgALAP(ns.alap); // the time frames DG is made of
+	vector<vector<double>> DGsum;
+	trackFrames = true;
+	tightened.clear();
+	// bring DG up to date, and order readyList by priority function (force) in decresing order
+	// the force (original, successor and predecessor) of every ready op is evaluated once (in parallel) as its key
+	auto prioritize = [&]()
+		{
+			// the latency may have been extended, and an op may still be ready after its ALAP,
+			// so the rows must cover both
+			size_t steps = max(ConstrainedLatency,cstep + 1) + MUL_DELAY;
+			for (auto& row : DG)
+				if (row.size() < steps)
+					row.resize(steps,0);
+			for (auto v : tightened)
+				if (ns.asap[v] != dgASAP[v] || ns.alap[v] != dgALAP[v])
+				{
+					addDG(DG,v,dgASAP[v],dgALAP[v],-1);
+					addDG(DG,v,ns.asap[v],ns.alap[v],1);
+					dgASAP[v] = ns.asap[v];
+					dgALAP[v] = ns.alap[v];
+				}
+			tightened.clear();
+			if (CHECK)
+				checkDG(DG);
+			prefixDG(DG,DGsum);
+			newForceVersion();
+			pool.run(readyList.size(),4,[&](int k,int) { force[readyList[k]->num] = calTotalForce(readyList[k],cstep,DGsum); });
+			std::sort(readyList.begin(),readyList.end(),
+					[&force](VNode* const& v1, VNode* const& v2) // lambda
+					{ return (force[v1->num] > force[v2->num]); });
+		};
+
 	while (numScheduledOp < vertex)
 	{
 		cstep++;
@@ -153,70 +663,50 @@ void graph::RC_FDS() // Resource-constrained Force-Directed Scheduling
 		{
 			int flag = 1;
 			for (auto ppred = (*pnode)->pred.cbegin(); ppred != (*pnode)->pred.cend(); ++ppred)
-				if ((*ppred)->cstep == 0)
+				if ((*ppred)->cstep() == 0)
 					flag = 0;
-			if (mark[(*pnode)->num] == 0 && (*pnode)->asap <= cstep && flag == 1)
+			if (mark[(*pnode)->num] == 0 && (*pnode)->asap() <= cstep && flag == 1)
 			{
 				readyList.push_back(*pnode);
 				mark[(*pnode)->num] = 1; // have been pushed into readyList
 			}
 		}
-
-		// build distribution graph
-		label: map<string,vector<double>> DG;// type step dg
-		for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-		{
-			vector<double> temp(ConstrainedLatency+MUL_DELAY,0);
-			DG[mapResourceType(pnr->first)] = temp;
-		}
-		for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
-			for (int i = (*pnode)->asap; i <= (*pnode)->alap; ++i)
-				for (int d = 0; d < (*pnode)->delay; ++d)
-					DG[mapResourceType((*pnode)->type)][i+d] += 1/(double)((*pnode)->getLength()); // (*pnode)->length
-
-		// sort the readyList by priority function (force) in decresing order
-		std::sort(readyList.begin(),readyList.end(),
-				[this,cstep,&DG](VNode* const& v1, VNode* const& v2) // lambda
-				{
-					// original force
-					double f1 = calForce(v1->asap,v1->alap,cstep,cstep,DG.at(mapResourceType(v1->type)),v1->delay); // cannot use [], which is non-const
-					// successor force
-					f1 += calSuccForce(v1,cstep,DG);
-					// predecessor force
-					f1 += calPredForce(v1,cstep,DG);
-					double f2 = calForce(v2->asap,v2->alap,cstep,cstep,DG.at(mapResourceType(v2->type)),v2->delay);
-					f2 += calSuccForce(v2,cstep,DG);
-					f2 += calPredForce(v2,cstep,DG);
-					return (f1 > f2);
-				});
+		prioritize();
 
 		// test if the operations in readyList can be placed in this cstep
-		for (int i = 0; i < readyList.size(); )
+		// (the placements do not change the time frames of the other ready ops, all their predecessors are placed)
+		size_t urgent = count_if(readyList.begin(),readyList.end(),[cstep](VNode* const& op) { return op->alap() == cstep; });
+		for (size_t i = 0; i < readyList.size(); )
 		{
-			int cnt = 0;
-			for (auto op: readyList)
-				if (op->alap == cstep)
-					cnt++;
-			if (cnt == readyList.size())
+			if (urgent == readyList.size())
 			{
 				// extend maximum latency
+				// the frames of the ready ops are shifted by one step, DG is updated for them only
 				for (auto pnode = readyList.cbegin(); pnode != readyList.cend(); ++pnode)
-					(*pnode)->extendALAP((*pnode)->alap+1);
+				{
+					(*pnode)->extendALAP((*pnode)->alap()+1);
+					tightened.push_back((*pnode)->num);
+				}
 				ConstrainedLatency++;
-				// reevaluate time frames
-				goto label;
+				urgent = 0;
+				// reevaluate the forces and start over
+				prioritize();
+				i = 0;
+				continue;
 			}
-			// cout << readyList[i]->num+1 << " " << readyList[i]->asap << " " << readyList[i]->alap << endl;
+			// cout << readyList[i]->num+1 << " " << readyList[i]->asap() << " " << readyList[i]->alap() << endl;
 			int flag = 1;
-			for (int d = 1; d <= readyList[i]->delay; ++d)
+			for (int d = 1; d <= readyList[i]->delay(); ++d)
 			{
 				if (cstep+d-1 >= nrt.size())
-					nrt.push_back(temp); // important!
-				if (nrt[cstep+d-1][mapResourceType(readyList[i]->type)]+1 > maxNr[mapResourceType(readyList[i]->type)])
+					nrt.push_back(); // important!
+				if (nrt[cstep+d-1][readyList[i]->rtype]+1 > maxNr[readyList[i]->rtype])
 					flag = 0;
 			}
 			if (flag == 1)
 			{
+				if (readyList[i]->alap() == cstep)
+					urgent--;
 				scheduleNodeStepResource(readyList[i],cstep,2); // update time frame
 				readyList.erase(readyList.begin()+i);
 				i--;
@@ -224,8 +714,10 @@ void graph::RC_FDS() // Resource-constrained Force-Directed Scheduling
 			i++;
 		}
 	}
+	trackFrames = false;
 	auto t2 = Clock::now();
 	print("Placing operations done!\n");
 	print("Finish force-directed scheduling!\n");
-	cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
-}
\ No newline at end of file
+	if (!QUIET)
+		cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+}
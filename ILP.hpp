@@ -12,7 +12,7 @@ void graph::generateTC_ILP(ofstream& outfile)
 	cout << "Time frame:" << endl;
 	int cnt = 1;
 	for (auto pnode : adjlist)
-	 	cout << pnode->num+1 << ": [ " << pnode->asap << " , " << pnode->alap << " ]" << endl;
+	 	cout << pnode->num+1 << ": [ " << pnode->asap() << " , " << pnode->alap() << " ]" << endl;
 	cout << endl;
 	cout << "Start generating ILP formulas for latency-constrained problems..." << endl;
 
@@ -24,8 +24,8 @@ void graph::generateTC_ILP(ofstream& outfile)
 	// Time frame constraints
 	for (auto pnode : adjlist)
 	{
-		for (int i = pnode->asap; i <= pnode->alap; ++i)
-			outfile << "x" << cnt << "," << i << (i == pnode->alap ? " = 1\n" : " + ");
+		for (int i = pnode->asap(); i <= pnode->alap(); ++i)
+			outfile << "x" << cnt << "," << i << (i == pnode->alap() ? " = 1\n" : " + ");
 		cnt++;
 	}
 	cout << "Time frame constraints generated." << endl;
@@ -33,23 +33,23 @@ void graph::generateTC_ILP(ofstream& outfile)
 	// Resource constraints
 	cnt = 0;
 	for (cnt = 0; cnt < vertex; ++cnt)
-		for (int i = adjlist[cnt]->asap; i <= adjlist[cnt]->alap + adjlist[cnt]->delay - 1; ++i)
+		for (int i = adjlist[cnt]->asap(); i <= adjlist[cnt]->alap() + adjlist[cnt]->delay() - 1; ++i)
 			// cout << i << " " << adjlist[cnt]->type << endl;
-			rowResource[i][mapResourceType(adjlist[cnt]->type)].push_back(cnt); // push delay
+			rowResource[i][adjlist[cnt]->rtype].push_back(cnt); // push delay
 	cout << "Critical path delay: " << ConstrainedLatency << endl;
 	for (int i = 1; i <= ConstrainedLatency; ++i)
-		for (auto ptype = nr.cbegin(); ptype != nr.cend(); ++ptype)
+		for (int r = 0; r < typeNum; ++r)
 		{
-			if (rowResource[i][ptype->first].size() < 2)
+			if (rowResource[i][r].size() < 2)
 				continue;
-			for (int j = 0; j < rowResource[i][ptype->first].size(); ++j)
-				for (int d = 0; d < adjlist[rowResource[i][ptype->first][j]]->delay; ++d)
+			for (int j = 0; j < rowResource[i][r].size(); ++j)
+				for (int d = 0; d < adjlist[rowResource[i][r][j]]->delay(); ++d)
 					if (i-d >= 1)
-						outfile << "x" << rowResource[i][ptype->first][j]
-								<< "," << i-d << ((j == rowResource[i][ptype->first].size()-1 && (d == adjlist[rowResource[i][ptype->first][j]]->delay-1 || i-d == 1)) ? "" : " + ");
+						outfile << "x" << rowResource[i][r][j]
+								<< "," << i-d << ((j == rowResource[i][r].size()-1 && (d == adjlist[rowResource[i][r][j]]->delay()-1 || i-d == 1)) ? "" : " + ");
 					else
 						break;
-			if (ptype->first == "MUL") // ptype->first == "mul" || 
+			if (typeName[r] == "MUL") // typeName[r] == "mul" || 
 				outfile << " - M1 <= 0" << endl;
 			else
 				outfile << " - M2 <= 0" << endl;
@@ -60,21 +60,21 @@ void graph::generateTC_ILP(ofstream& outfile)
 	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
 		for (auto psucc = (*pnode)->succ.cbegin(); psucc != (*pnode)->succ.cend(); ++psucc)
 		{
-			for (int i = (*pnode)->asap; i <= (*pnode)->alap; ++i)
+			for (int i = (*pnode)->asap(); i <= (*pnode)->alap(); ++i)
 				outfile << i << " x" << (*pnode)->num << ","
-						<< i << (i == (*pnode)->alap ? "" : " + ");
+						<< i << (i == (*pnode)->alap() ? "" : " + ");
 			outfile << " - ";
-			for (int i = (*psucc)->asap; i <= (*psucc)->alap; ++i)
+			for (int i = (*psucc)->asap(); i <= (*psucc)->alap(); ++i)
 				outfile << i << " x" << (*psucc)->num << ","
-						<< i << (i == (*psucc)->alap ? "" : " - ");
-			outfile << " <= -" << (*pnode)->delay << endl;
+						<< i << (i == (*psucc)->alap() ? "" : " - ");
+			outfile << " <= -" << (*pnode)->delay() << endl;
 		}
 	cout << "Precedence constraints generated." << endl;
 
 	// Bounds NO VARIABLES RHS!
 	outfile << "Bounds" << endl;
 	for (int i = 0; i < vertex; ++i)
-		for (int j = adjlist[i]->asap; j <= adjlist[i]->alap; ++j)
+		for (int j = adjlist[i]->asap(); j <= adjlist[i]->alap(); ++j)
 			// outfile << "x" << i << "," << j << " >= 0" <<endl;
 			outfile << "0 <= x" << i << "," << j << " <= 1" <<endl;
 	outfile << "M1 >= 1" << endl;
@@ -84,7 +84,7 @@ void graph::generateTC_ILP(ofstream& outfile)
 	// Generals
 	outfile << "Generals" << endl;
 	for (int i = 0; i < vertex; ++i)
-		for (int j = adjlist[i]->asap; j <= adjlist[i]->alap; ++j)
+		for (int j = adjlist[i]->asap(); j <= adjlist[i]->alap(); ++j)
 			outfile << "x" << i << "," << j << "\n";
 	outfile << "M1\nM2" << endl;
 	cout << "Generals generated." << endl;
@@ -114,7 +114,7 @@ void graph::generateRC_ILP(ofstream& outfile)
 	for (auto pnode = adjlist.begin(); pnode != adjlist.end(); ++pnode)
 	{
 		(*pnode)->setALAP(vertex); // set upper bound
-		cout << cnt++ << ": [ " << (*pnode)->asap << " , " << (*pnode)->alap << " ]" << endl;
+		cout << cnt++ << ": [ " << (*pnode)->asap() << " , " << (*pnode)->alap() << " ]" << endl;
 	}
 	cout << endl;
 	cout << "Start generating ILP formulas for resource-constrained problems..." << endl;
@@ -127,11 +127,11 @@ void graph::generateRC_ILP(ofstream& outfile)
 	// Time frame constraints
 	for (auto pnode : adjlist)
 	{
-		for (int i = pnode->asap; i <= pnode->alap; ++i)
-			outfile << "x" << cnt << "," << i << (i == pnode->alap ? " = 1\n" : " + ");
+		for (int i = pnode->asap(); i <= pnode->alap(); ++i)
+			outfile << "x" << cnt << "," << i << (i == pnode->alap() ? " = 1\n" : " + ");
 		// (t+d-1) x
-		for (int i = pnode->asap; i <= pnode->alap; ++i)
-			outfile << (i + pnode->delay - 1) << " x" << cnt << "," << i << " - L <= 0" << endl;
+		for (int i = pnode->asap(); i <= pnode->alap(); ++i)
+			outfile << (i + pnode->delay() - 1) << " x" << cnt << "," << i << " - L <= 0" << endl;
 		cnt++;
 	}
 	cout << "Time frame and upper latency constraints generated." << endl;
@@ -139,23 +139,23 @@ void graph::generateRC_ILP(ofstream& outfile)
 	// Resource constraints
 	cnt = 0;
 	for (cnt = 0; cnt < vertex; ++cnt)
-		for (int i = adjlist[cnt]->asap; i <= adjlist[cnt]->alap + adjlist[cnt]->delay - 1; ++i)
+		for (int i = adjlist[cnt]->asap(); i <= adjlist[cnt]->alap() + adjlist[cnt]->delay() - 1; ++i)
 			// cout << i << " " << adjlist[cnt]->type << endl;
-			rowResource[i][mapResourceType(adjlist[cnt]->type)].push_back(cnt); // push delay
+			rowResource[i][adjlist[cnt]->rtype].push_back(cnt); // push delay
 	// cout << "Critical path delay: " << ConstrainedLatency << endl;
 	for (int i = 1; i <= vertex; ++i) // ConstrainedLatency
-		for (auto ptype = nr.cbegin(); ptype != nr.cend(); ++ptype)
+		for (int r = 0; r < typeNum; ++r)
 		{
-			if (rowResource[i][ptype->first].size() < 2)
+			if (rowResource[i][r].size() < 2)
 				continue;
-			for (int j = 0; j < rowResource[i][ptype->first].size(); ++j)
-				for (int d = 0; d < adjlist[rowResource[i][ptype->first][j]]->delay; ++d)
+			for (int j = 0; j < rowResource[i][r].size(); ++j)
+				for (int d = 0; d < adjlist[rowResource[i][r][j]]->delay(); ++d)
 					if (i-d >= 1)
-						outfile << "x" << rowResource[i][ptype->first][j]
-								<< "," << i-d << ((j == rowResource[i][ptype->first].size()-1 && (d == adjlist[rowResource[i][ptype->first][j]]->delay-1 || i-d == 1)) ? "" : " + ");
+						outfile << "x" << rowResource[i][r][j]
+								<< "," << i-d << ((j == rowResource[i][r].size()-1 && (d == adjlist[rowResource[i][r][j]]->delay()-1 || i-d == 1)) ? "" : " + ");
 					else
 						break;
-			outfile << " <= " << MAXRESOURCE[ptype->first] << endl;
+			outfile << " <= " << MAXRESOURCE[typeName[r]] << endl;
 		}
 	cout << "Resource constraints generated." << endl;
 
@@ -163,21 +163,21 @@ void graph::generateRC_ILP(ofstream& outfile)
 	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
 		for (auto psucc = (*pnode)->succ.cbegin(); psucc != (*pnode)->succ.cend(); ++psucc)
 		{
-			for (int i = (*pnode)->asap; i <= (*pnode)->alap; ++i)
+			for (int i = (*pnode)->asap(); i <= (*pnode)->alap(); ++i)
 				outfile << i << " x" << (*pnode)->num << ","
-						<< i << (i == (*pnode)->alap ? "" : " + ");
+						<< i << (i == (*pnode)->alap() ? "" : " + ");
 			outfile << " - ";
-			for (int i = (*psucc)->asap; i <= (*psucc)->alap; ++i)
+			for (int i = (*psucc)->asap(); i <= (*psucc)->alap(); ++i)
 				outfile << i << " x" << (*psucc)->num << ","
-						<< i << (i == (*psucc)->alap ? "" : " - ");
-			outfile << " <= -" << (*pnode)->delay << endl;
+						<< i << (i == (*psucc)->alap() ? "" : " - ");
+			outfile << " <= -" << (*pnode)->delay() << endl;
 		}
 	cout << "Precedence constraints generated." << endl;
 
 	// Bounds NO VARIABLES RHS!
 	outfile << "Bounds" << endl;
 	for (int i = 0; i < vertex; ++i)
-		for (int j = adjlist[i]->asap; j <= adjlist[i]->alap; ++j)
+		for (int j = adjlist[i]->asap(); j <= adjlist[i]->alap(); ++j)
 			// outfile << "x" << i << "," << j << " >= 0" <<endl;
 			outfile << "0 <= x" << i << "," << j << " <= 1" <<endl;
 	outfile << "L >= 1" << endl;
@@ -186,7 +186,7 @@ void graph::generateRC_ILP(ofstream& outfile)
 	// Generals
 	outfile << "Generals" << endl;
 	for (int i = 0; i < vertex; ++i)
-		for (int j = adjlist[i]->asap; j <= adjlist[i]->alap; ++j)
+		for (int j = adjlist[i]->asap(); j <= adjlist[i]->alap(); ++j)
 			outfile << "x" << i << "," << j << "\n";
 	outfile << "L" << endl;
 	cout << "Generals generated." << endl;
@@ -5,6 +5,12 @@
 
 // This file contains the implementation of list scheduling (LS).
 
+// the ops are placed in rounds, every round tries the unscheduled ops in order of priority under the bounds maxNr,
+// each op at its first step in [ASAP,ALAP] that fits, found on the calendar of its type (full steps of N_r(t))
+// an op fails only if every step of its frame is full, i.e. its type has reached its bound,
+// so the bounds of the failed types are raised by one for the next round, and the failed ops are the only ones left
+// pending only keeps them (compacted in place), and only the calendars of the raised types are rebuilt
+template <class Priority>
 void graph::TC_LS() // Time-constrained List Scheduling
 {
 	print("Begin time-constrained list scheduling (LS)...\n");
@@ -14,58 +20,74 @@ void graph::TC_LS() // Time-constrained List Scheduling
 	topologicalSortingDFS();
 
 	// initialize N_r(t)
-	map<string,int> temp;
-	for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-		temp[pnr->first] = 0;
-	for (int i = 0; i <= ConstrainedLatency; ++i) // number+1
-		nrt.push_back(temp);
+	nrt.assign(ConstrainedLatency+1,typeNum); // number+1
 
 	print("Begin placing operations...");
 	clearMark();
 	setDegrees();
 
+	ListContext ctx;
+	listContext(ctx,Priority::needsLevel,Priority::needsForce);
+	vector<double> key(vertex);
+	for (int v = 0; v < vertex; ++v)
+		key[v] = Priority::key(adjlist[v],ctx);
 	std::sort(order.begin(),order.end(),
-		[this](VNode* const& v1, VNode* const& v2) // lambda
-		// { return (v1->alap - v1->asap < v2->alap - v2->asap); });
-		{ return (v1->alap < v2->alap); });
+		[&key](VNode* const& v1, VNode* const& v2) // lambda
+		{ return make_pair(key[v1->num],v1->num) < make_pair(key[v2->num],v2->num); });
 
-	while (numScheduledOp < vertex)
+	vector<VNode*> pending(order);
+	vector<int> maxNr(typeNum,1);
+	vector<bool> failed(typeNum,false);
+	calendar.assign(typeNum);
+	long long probes = 0;
+	int rounds = 0;
+	while (!pending.empty())
 	{
-		vector<VNode*> readyList;
-		for (auto pnode = order.cbegin(); pnode != order.cend(); ++pnode)
-			if (mark[(*pnode)->num] == 0)
-				readyList.push_back(*pnode);
-		// printf("Scheduled %d ops. Len readyList: %d\n",numScheduledOp,readyList.size());
-		map<string,int> maxNr;
-		for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-			maxNr[mapResourceType(pnr->first)] = maxNrt[mapResourceType(pnr->first)] + 1;
-		for (auto pnode = readyList.cbegin(); pnode != readyList.cend(); ++pnode)
-			for (int step = (*pnode)->asap; step <= (*pnode)->alap; ++step)
+		rounds++;
+		int kept = 0;
+		for (auto pnode = pending.cbegin(); pnode != pending.cend(); ++pnode)
+		{
+			int r = (*pnode)->rtype;
+			int step = calendar.firstFree(r,(*pnode)->asap(),(*pnode)->delay());
+			probes++;
+			if (step > (*pnode)->alap())
 			{
-				bool flag_in = true;
-				for (int delay = 0; delay < (*pnode)->delay; delay++)
-					if (nrt[step+delay][mapResourceType((*pnode)->type)] + 1 > maxNr[mapResourceType((*pnode)->type)])
-					{
-						flag_in = false;
-						break;
-					}
-				if (flag_in)
-				{
-					scheduleNodeStep(*pnode,step,2);
-					// printf("Schedule node %d at %d\n",(*pnode)->num,step);
-					mark[(*pnode)->num] = 1;
-					break;
-				}
+				failed[r] = true;
+				pending[kept++] = *pnode;
+				continue;
+			}
+			scheduleNodeStep(*pnode,step,2);
+			mark[(*pnode)->num] = 1;
+			for (int i = step; i < step + (*pnode)->delay(); ++i)
+				calendar.set(r,i,nrt[i][r] >= maxNr[r]);
+		}
+		pending.resize(kept);
+		for (int r = 0; r < typeNum; ++r)
+			if (failed[r])
+			{
+				failed[r] = false;
+				maxNr[r]++;
+				for (int i = 0; i <= ConstrainedLatency; ++i)
+					calendar.set(r,i,nrt[i][r] >= maxNr[r]);
 			}
 	}
 
 	auto t2 = Clock::now();
 	print("Placing operations done!\n");
+	print("Placement rounds: " + to_string(rounds) + ", calendar probes: " + to_string(probes));
 
 	print("Finish list scheduling!\n");
-	cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+	if (!QUIET)
+		cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
 }
 
+// event-driven: an op is released when its last predecessor is placed (its ASAP is then final),
+// and enters the ready heap of its type at its ASAP
+// each step pops the most urgent ready ops (least key of the priority policy, then node number)
+// up to the free resources of their type, the steps without any ready op are skipped
+// O((V+E) log V) for the heaps
+// the ops of a type without constraint (0) are placed as soon as they are ready, as in placeFirstFit
+template <class Priority>
 void graph::RC_LS() // Resource-constrained List Scheduling
 {
 	print("Begin resource-constrained list scheduling (LS)...\n");
@@ -75,52 +97,64 @@ void graph::RC_LS() // Resource-constrained List Scheduling
 	topologicalSortingDFS();
 
 	// initialize N_r(t)
-	map<string,int> temp,maxNr;
-	for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
-	{
-		temp[pnr->first] = 0;
-		maxNr[pnr->first] = MAXRESOURCE[pnr->first];
-	}
-	for (int i = 0; i < vertex; ++i)
-		nrt.push_back(temp);
+	vector<int> maxNr = resourceBound();
+	nrt.assign(1,typeNum); // nrt[0], grown by bookResource
+	calendar.assign(typeNum);
 
 	print("Begin placing operations...");
-	clearMark();
 	setDegrees();
-	vector<VNode*> readyList;
-
-	// sort by priority function
-	std::sort(order.begin(),order.end(),
-			[this](VNode* const& v1, VNode* const& v2) // lambda
-			{ return ((v1->alap - v2->asap) < (v1->alap - v2->alap)); });
+	const int* asap = ns.asap.data();
+	ListContext ctx;
+	listContext(ctx,Priority::needsLevel,Priority::needsForce);
+	// released ops by (ASAP, node number), min-heap
+	vector<pair<int,int>> released;
+	auto later = greater<pair<int,int>>();
+	for (int v = 0; v < vertex; ++v)
+		if (adjlist[v]->tempIncoming == 0)
+			released.push_back(make_pair(asap[v],v));
+	make_heap(released.begin(),released.end(),later);
+	// ready ops of every type by (key, node number), min-heaps
+	vector<vector<pair<double,int>>> ready(typeNum);
+	auto lessUrgent = greater<pair<double,int>>();
+	int numReady = 0;
 
-	// while there're unscheduled operations
 	for (int cstep = 1; numScheduledOp < vertex; ++cstep)
 	{
+		if (numReady == 0) // nothing to place before the next release
+			cstep = max(cstep,released.front().first);
 		// determine the ready operations
-		for (auto pnode = order.cbegin(); pnode != order.cend(); ++pnode)
-			if (mark[(*pnode)->num] == 0 && (*pnode)->tempIncoming == 0 && (*pnode)->asap <= cstep) // in-degree = 0
-			{
-				readyList.push_back(*pnode);
-				mark[(*pnode)->num] = 1; // have been pushed into readyList
-			}
+		while (!released.empty() && released.front().first <= cstep)
+		{
+			int v = released.front().second;
+			pop_heap(released.begin(),released.end(),later);
+			released.pop_back();
+			vector<pair<double,int>>& heap = ready[adjlist[v]->rtype];
+			heap.push_back(make_pair(Priority::key(adjlist[v],ctx),v));
+			push_heap(heap.begin(),heap.end(),lessUrgent);
+			numReady++;
+		}
+		while (cstep >= nrt.size())
+			nrt.push_back();
 
-		// determine eligible operations in c-step and schedule them
-		for (int i = 0; i < readyList.size(); )
+		// schedule the most urgent ones, the ops placed earlier that still run in later steps
+		// have started by cstep, so a free slot at cstep is free for the whole delay
+		for (int r = 0; r < typeNum; ++r)
 		{
-			bool flag = true;
-			for (int d = 1; d <= readyList[i]->delay; ++d)
-				if (nrt[cstep+d-1][mapResourceType(readyList[i]->type)]+1 > maxNr.at(mapResourceType(readyList[i]->type)))
-					flag = false;
-			if (flag)
+			vector<pair<double,int>>& heap = ready[r];
+			while (!heap.empty() && (maxNr[r] == 0 || nrt[cstep][r] < maxNr[r]))
 			{
-				scheduleNodeStepResource(readyList[i],cstep,2);
-				for (auto pnode = readyList[i]->succ.begin(); pnode != readyList[i]->succ.end(); ++pnode)
-					(*pnode)->tempIncoming--;
-				readyList.erase(readyList.begin()+i);
-				i--;
+				VNode* node = adjlist[heap.front().second];
+				pop_heap(heap.begin(),heap.end(),lessUrgent);
+				heap.pop_back();
+				numReady--;
+				bookResource(node,cstep,0,maxNr); // the ASAP of the successors is updated
+				for (auto pnode = node->succ.begin(); pnode != node->succ.end(); ++pnode)
+					if (--(*pnode)->tempIncoming == 0)
+					{
+						released.push_back(make_pair((*pnode)->asap(),(*pnode)->num));
+						push_heap(released.begin(),released.end(),later);
+					}
 			}
-			i++;
 		}
 	}
 
@@ -128,5 +162,100 @@ void graph::RC_LS() // Resource-constrained List Scheduling
 	print("Placing operations done!\n");
 
 	print("Finish list scheduling!\n");
-	cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
-}
\ No newline at end of file
+	if (!QUIET)
+		cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+}
+
+// the data of the priority policies, once the time frames are known
+// force: DG is made of the frames with the latency of the schedule (the critical path for RC),
+// the key is the self force of the op at its ASAP, as in FDS
+void graph::listContext(ListContext& ctx,bool level,bool force) const
+{
+	if (level)
+	{
+		ctx.level.assign(vertex,0);
+		for (auto pnode = order.crbegin(); pnode != order.crend(); ++pnode) // order is topological
+		{
+			int l = 0;
+			for (auto psucc = (*pnode)->succ.cbegin(); psucc != (*pnode)->succ.cend(); ++psucc)
+				l = max(l,ctx.level[(*psucc)->num]);
+			ctx.level[(*pnode)->num] = l + 1;
+		}
+	}
+	if (!force)
+		return;
+	int horizon = (MODE[0] < 10 ? ConstrainedLatency : cdepth);
+	int shift = ConstrainedLatency - horizon; // ALAP at the horizon
+	vector<vector<double>> DG(typeNum,vector<double>(horizon + MUL_DELAY + 1,0)), DGsum;
+	for (int v = 0; v < vertex; ++v)
+		addDG(DG,v,ns.asap[v],ns.alap[v] - shift,1);
+	prefixDG(DG,DGsum);
+	ctx.force.assign(vertex,0);
+	for (int v = 0; v < vertex; ++v)
+	{
+		int a = ns.asap[v], b = ns.alap[v] - shift;
+		ctx.force[v] = calForce(a,b,a,a,DGsum[adjlist[v]->rtype],ns.delay[v]);
+	}
+}
+
+template <class Priority>
+void graph::runLS()
+{
+	if (MODE[0] >= 10)
+		RC_LS<Priority>();
+	else
+		TC_LS<Priority>();
+}
+
+// the policies run one after the other on copies of the graph (not concurrently, so that the times compare),
+// the best one is the least total resources (TC) or the least latency (RC), ties go to the first one
+void graph::comparePriorities()
+{
+	print("Begin comparing the priority policies of LS...\n");
+	auto t1 = Clock::now();
+	bool rc = (MODE[0] >= 10);
+	const char* name[] = {ALAPPriority::name,MobilityPriority::name,PathPriority::name,SuccessorPriority::name,ForcePriority::name};
+	void (graph::*run[])() = {&graph::runLS<ALAPPriority>,&graph::runLS<MobilityPriority>,&graph::runLS<PathPriority>,
+		&graph::runLS<SuccessorPriority>,&graph::runLS<ForcePriority>};
+	int policies = sizeof(run) / sizeof(run[0]);
+
+	cout << std::left << setw(12) << "priority" << setw(10) << "latency" << setw(12) << "resources" << "time (ns)" << endl;
+	int best = 0;
+	pair<int,int> bestScore;
+	for (int i = 0; i < policies; ++i)
+	{
+		graph g(*this); // only reads this graph
+		g.PRINT = false;
+		g.QUIET = true;
+		g.resetSchedule();
+		auto start = Clock::now();
+		(g.*run[i])();
+		auto end = Clock::now();
+		int sum_r = 0;
+		for (int r = 0; r < typeNum; ++r)
+			sum_r += g.nrt.peak[r];
+		cout << setw(12) << name[i] << setw(10) << g.maxLatency << setw(12) << sum_r
+			<< std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << endl;
+		// (resources, latency) for TC, (latency, resources) for RC
+		pair<int,int> score = (rc ? make_pair(g.maxLatency,sum_r) : make_pair(sum_r,g.maxLatency));
+		if (i == 0 || score < bestScore)
+		{
+			best = i;
+			bestScore = score;
+		}
+	}
+	cout << std::right;
+	print("Best priority: " + string(name[best]) + "\n");
+
+	// schedule the winner on this graph
+	resetSchedule();
+	bool quiet = QUIET;
+	QUIET = true;
+	auto winner = run[best];
+	(this->*winner)();
+	QUIET = quiet;
+	auto t2 = Clock::now();
+	print("Finish comparing the priority policies!\n");
+	if (!QUIET)
+		cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+}
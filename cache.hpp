@@ -0,0 +1,232 @@
+// Copyright (c) 2018 Hongzheng Chen
+// E-mail: chenhzh37@mail2.sysu.edu.cn
+
+// This is the implementation of Entropy-directed scheduling (EDS) algorithm for FPGA high-level synthesis.
+
+// This file contains the binary graph cache (.edsg) written next to the dot file.
+
+// Layout of a .edsg file (native byte order, all integers are 32-bit unless stated)
+//     EdsgHeader
+//     typeOffset[typeNum+1]	type names, interned
+//     nameOffset[vertex+1]		node names
+//     nodeType[vertex]			index into the type names
+//     nodeDelay[vertex]
+//     edges[2*edge]			(from, to) of every edge, in the order and orientation of the dot file
+//     typeChars[typeBytes] nameChars[nameBytes]
+// The edges are read back in file order through addArc as if parsed, so pred/succ (built by buildCSR)
+// and ilp are the same as after a cold parse (and thus the schedules do not depend on whether the cache was hit).
+// The cache is stale if the dot file's size or modification time, MUL_DELAY
+// or the version changes, and corrupted if the checksum of the payload mismatches.
+// In both cases the dot file is parsed again and the cache is rewritten.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#define EDSG_VERSION 2
+
+struct EdsgHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t dotSize;
+	int64_t dotMtime;
+	uint64_t checksum; // FNV-1a of the payload
+	uint32_t mulDelay;
+	uint32_t vertex;
+	uint32_t edge;
+	uint32_t typeNum;
+	uint32_t typeBytes;
+	uint32_t nameBytes;
+};
+
+static uint64_t edsgChecksum(const char* p,size_t size)
+{
+	uint64_t h = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; ++i)
+	{
+		h ^= (unsigned char)p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+static string edsgPath(const char* path)
+{
+	string file(path);
+	if (file.size() >= 4 && file.compare(file.size() - 4,4,".dot") == 0)
+		file.erase(file.size() - 4);
+	return file + ".edsg";
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+static bool edsgStamp(const char* path,uint64_t& size,int64_t& mtime)
+{
+	struct stat st;
+	if (stat(path,&st) < 0)
+		return false;
+	size = st.st_size;
+#if defined(__linux__)
+	mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#else
+	mtime = (int64_t)st.st_mtime * 1000000000LL;
+#endif
+	return true;
+}
+
+bool graph::readCache(const char* path)
+{
+	uint64_t dotSize;
+	int64_t dotMtime;
+	if (!edsgStamp(path,dotSize,dotMtime))
+		return false;
+	string file = edsgPath(path);
+	int fd = open(file.c_str(),O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd,&st) < 0 || st.st_size < (off_t)sizeof(EdsgHeader))
+	{
+		close(fd);
+		return false;
+	}
+	size_t size = st.st_size;
+	void* buf = mmap(nullptr,size,PROT_READ,MAP_PRIVATE,fd,0);
+	close(fd);
+	if (buf == MAP_FAILED)
+		return false;
+	bool ok = loadCache((const char*)buf,size,dotSize,dotMtime);
+	munmap(buf,size);
+	return ok;
+}
+
+void graph::writeCache(const char* path) const
+{
+	EdsgHeader h;
+	memcpy(h.magic,"EDSG",4);
+	h.version = EDSG_VERSION;
+	if (!edsgStamp(path,h.dotSize,h.dotMtime))
+		return;
+	h.mulDelay = MUL_DELAY;
+	h.vertex = vertex;
+	h.edge = edge;
+
+	// intern types in order of appearance
+	map<string,uint32_t> typeId;
+	vector<uint32_t> typeOffset(1,0), nameOffset(1,0), nodeType, nodeDelay;
+	string typeChars, nameChars;
+	for (auto pnode : adjlist)
+	{
+		auto ptype = typeId.find(pnode->type);
+		if (ptype == typeId.end())
+		{
+			ptype = typeId.insert(make_pair(pnode->type,(uint32_t)typeId.size())).first;
+			typeChars += pnode->type;
+			typeOffset.push_back(typeChars.size());
+		}
+		nodeType.push_back(ptype->second);
+		nodeDelay.push_back(pnode->delay());
+		nameChars += pnode->name;
+		nameOffset.push_back(nameChars.size());
+	}
+	h.typeNum = typeId.size();
+	h.typeBytes = typeChars.size();
+	h.nameBytes = nameChars.size();
+
+	// ilp keeps the edges in the order and orientation of the dot file
+	vector<uint32_t> edges;
+	edges.reserve(2 * ilp.size());
+	for (auto& cons : ilp)
+	{
+		edges.push_back(cons[0]);
+		edges.push_back(cons[1]);
+	}
+
+	string payload;
+	auto append = [&payload](const auto& v) // int and uint32_t have the same layout here
+		{ payload.append((const char*)v.data(),v.size() * sizeof(uint32_t)); };
+	append(typeOffset);
+	append(nameOffset);
+	append(nodeType);
+	append(nodeDelay);
+	append(edges);
+	payload += typeChars;
+	payload += nameChars;
+	h.checksum = edsgChecksum(payload.data(),payload.size());
+
+	// write to a temporary file first, so that concurrent readers never see a partial cache
+	string file = edsgPath(path), temp = file + "." + to_string(getpid()) + ".tmp";
+	ofstream outfile(temp,ios::binary);
+	if (!outfile)
+		return;
+	outfile.write((const char*)&h,sizeof(h));
+	outfile.write(payload.data(),payload.size());
+	outfile.close();
+	if (!outfile || std::rename(temp.c_str(),file.c_str()) != 0)
+		std::remove(temp.c_str());
+	else
+		print("Graph cache written to " + file);
+}
+
+#else
+
+bool graph::readCache(const char* path) { return false; }
+void graph::writeCache(const char* path) const {}
+
+#endif
+
+// rebuild the graph from a cache image, returns false if it is stale or broken
+bool graph::loadCache(const char* buf,size_t size,uint64_t dotSize,int64_t dotMtime)
+{
+	EdsgHeader h;
+	memcpy(&h,buf,sizeof(h));
+	if (memcmp(h.magic,"EDSG",4) != 0 || h.version != EDSG_VERSION
+		|| h.dotSize != dotSize || h.dotMtime != dotMtime || h.mulDelay != (uint32_t)MUL_DELAY)
+		return false;
+	uint64_t V = h.vertex, E = h.edge, T = h.typeNum;
+	uint64_t words = (T + 1) + (V + 1) + V * 2 + E * 2;
+	if (size != sizeof(h) + words * sizeof(uint32_t) + h.typeBytes + h.nameBytes)
+		return false;
+	const char* payload = buf + sizeof(h);
+	if (edsgChecksum(payload,size - sizeof(h)) != h.checksum)
+		return false;
+
+	// the payload begins right after the 8-byte aligned header, so the words are aligned
+	const uint32_t* typeOffset = (const uint32_t*)payload;
+	const uint32_t* nameOffset = typeOffset + (T + 1);
+	const uint32_t* nodeType = nameOffset + (V + 1);
+	const uint32_t* nodeDelay = nodeType + V;
+	const uint32_t* edges = nodeDelay + V;
+	const char* typeChars = (const char*)(edges + 2 * E);
+	const char* nameChars = typeChars + h.typeBytes;
+
+	// sanity checks, a valid checksum does not mean a well-formed file
+	if (typeOffset[0] != 0 || typeOffset[T] != h.typeBytes || nameOffset[0] != 0 || nameOffset[V] != h.nameBytes)
+		return false;
+	for (uint64_t i = 0; i < T; ++i)
+		if (typeOffset[i] > typeOffset[i+1])
+			return false;
+	for (uint64_t i = 0; i < V; ++i)
+		if (nameOffset[i] > nameOffset[i+1] || nodeType[i] >= T)
+			return false;
+	for (uint64_t i = 0; i < 2 * E; ++i)
+		if (edges[i] >= V)
+			return false;
+
+	print("Begin loading graph cache...");
+	adjlist.reserve(V);
+	ns.reserve(V);
+	for (uint64_t i = 0; i < V; ++i)
+	{
+		uint32_t t = nodeType[i];
+		addVertex(string_view(nameChars + nameOffset[i],nameOffset[i+1] - nameOffset[i]),
+				string_view(typeChars + typeOffset[t],typeOffset[t+1] - typeOffset[t]));
+		adjlist.back()->delay() = nodeDelay[i];
+	}
+	arcs.reserve(E);
+	for (uint64_t i = 0; i < E; ++i)
+		addArc(edges[2 * i],edges[2 * i + 1]);
+	print("Loaded graph cache successfully!\n");
+	return true;
+}
@@ -0,0 +1,206 @@
+// Copyright (c) 2018 Hongzheng Chen
+// E-mail: chenhzh37@mail2.sysu.edu.cn
+
+// This is the implementation of Entropy-directed scheduling (EDS) algorithm for FPGA high-level synthesis.
+
+// This file contains the splitting of a graph into its weakly connected components,
+// which are scheduled independently and then merged under the shared resource constraints.
+
+#include <thread>
+#include <atomic>
+
+// weakly connected components (BFS on both directions of the CSR),
+// the nodes of a component are in increasing order, and the components in order of their first node
+vector<vector<int>> graph::weakComponents() const
+{
+	vector<vector<int>> comp;
+	vector<int> id(vertex,-1);
+	for (int s = 0; s < vertex; ++s)
+	{
+		if (id[s] != -1)
+			continue;
+		vector<int> members(1,s);
+		id[s] = comp.size();
+		for (size_t head = 0; head < members.size(); ++head)
+		{
+			int v = members[head];
+			for (int k = succOffset[v]; k < succOffset[v+1]; ++k)
+				if (id[succList[k]] == -1)
+				{
+					id[succList[k]] = comp.size();
+					members.push_back(succList[k]);
+				}
+			for (int k = predOffset[v]; k < predOffset[v+1]; ++k)
+				if (id[predList[k]] == -1)
+				{
+					id[predList[k]] = comp.size();
+					members.push_back(predList[k]);
+				}
+		}
+		sort(members.begin(),members.end());
+		comp.push_back(members);
+	}
+	return comp;
+}
+
+// the subgraph induced by the nodes in members (indices in g, increasing), renumbered from 0,
+// local[v] is the index of v in members (only read for the members)
+// the types keep their ids in g, the names are not indexed (no more edges are read) and no ILP is kept
+graph::graph(const graph& g,const vector<int>& members,const vector<int>& local):
+	vertex(members.size()), typeNum(g.typeNum), MUL_DELAY(g.MUL_DELAY),
+	typeIndex(g.typeIndex), typeName(g.typeName), nr(g.typeNum,0), r_delay(g.r_delay),
+	LC(g.LC), ConstrainedLatency(g.ConstrainedLatency), MAXRESOURCE(g.MAXRESOURCE), MODE(g.MODE),
+	PRINT(g.PRINT), CACHE(g.CACHE), CHECK(g.CHECK), QUIET(g.QUIET), moveBudget(g.moveBudget),
+	portfolioSize(g.portfolioSize), seed(g.seed)
+{
+	ns.reserve(vertex);
+	adjlist.reserve(vertex);
+	succOffset.assign(1,0);
+	predOffset.assign(1,0);
+	for (int i = 0; i < vertex; ++i)
+	{
+		VNode* node = g.adjlist[members[i]];
+		ns.push(node->delay());
+		nodes.emplace_back(i,node->rtype,node->name,node->type,&ns);
+		adjlist.push_back(&nodes.back());
+		nr[node->rtype]++;
+		// a component is closed under the edges, so every neighbour is in it
+		for (int k = g.succOffset[node->num]; k < g.succOffset[node->num+1]; ++k)
+			succList.push_back(local[g.succList[k]]);
+		for (int k = g.predOffset[node->num]; k < g.predOffset[node->num+1]; ++k)
+			predList.push_back(local[g.predList[k]]);
+		succOffset.push_back(succList.size());
+		predOffset.push_back(predList.size());
+	}
+	edge = succList.size();
+	buildCSR();
+	rankNodes();
+	clearMark();
+}
+
+// resource-constrained scheduling of the weakly connected components (RC EDS, IEDS, FDS or LS, by MODE[0]):
+// every component is scheduled alone (on a pool of threads, 0 for all the cores, the largest ones first)
+// with the whole resource constraints, then the schedules are merged under the shared constraints:
+// the ops go in order of their step in their component, each one keeps that step unless its type is full there
+// or a predecessor has been moved, then it goes to the first step after that where it fits (as in placeFirstFit)
+// so only the ops in conflict (and the ones after them) are moved, and the merge is O(V+E) plus the calendar
+// the components are aligned at their start or at their end, whichever gives the shorter schedule
+// returns false (and schedules nothing) if it does not apply: another mode, or a single component
+bool graph::scheduleComponents(int threads)
+{
+	if (MODE[0] != 10 && MODE[0] != 11 && MODE[0] != 13 && MODE[0] != 14)
+	{
+		if (!QUIET)
+			cout << "Splitting applies to RC EDS, IEDS, FDS and LS only, the graph is scheduled as a whole." << endl;
+		return false;
+	}
+	vector<vector<int>> comp = weakComponents();
+	if (comp.size() <= 1)
+	{
+		if (!QUIET)
+			cout << "The graph is weakly connected, it is scheduled as a whole." << endl;
+		return false;
+	}
+	print("Begin scheduling " + to_string(comp.size()) + " weakly connected components...\n");
+	auto t1 = Clock::now();
+
+	vector<int> bySize(comp.size());
+	for (size_t c = 0; c < comp.size(); ++c)
+		bySize[c] = c;
+	stable_sort(bySize.begin(),bySize.end(),[&comp](int c1,int c2) { return comp[c1].size() > comp[c2].size(); });
+	if (threads <= 0)
+		threads = max(1,(int)std::thread::hardware_concurrency());
+	threads = min(threads,(int)comp.size());
+	if (vertex < 500) // a thread costs about 10 us, i.e. RC_EDS of some 100 ops, so a small graph is left to one
+		threads = 1;
+
+	// the component of every op and its index there
+	vector<int> compOf(vertex), local(vertex);
+	for (size_t c = 0; c < comp.size(); ++c)
+		for (size_t i = 0; i < comp[c].size(); ++i)
+		{
+			compOf[comp[c][i]] = c;
+			local[comp[c][i]] = i;
+		}
+
+	// step of every op in the schedule of its component, and the latency of the components
+	vector<int> localStep(vertex,0);
+	vector<int> compLatency(comp.size(),0);
+	atomic<int> next(0);
+	auto worker = [&]()
+		{
+			for (int k = next++; k < (int)comp.size(); k = next++)
+			{
+				const vector<int>& members = comp[bySize[k]];
+				if (members.size() == 1) // a single op goes first in any schedule
+				{
+					localStep[members[0]] = 1;
+					compLatency[bySize[k]] = adjlist[members[0]]->delay();
+					continue;
+				}
+				graph g(*this,members,local); // only reads this graph
+				g.PRINT = false;
+				g.QUIET = true;
+				switch (MODE[0])
+				{
+					case 10: g.RC_EDS();break;
+					case 11: g.RC_IEDS();break;
+					case 13: g.RC_FDS(threads > 1 ? 1 : 0);break;
+					case 14: g.RC_LS();break;
+				}
+				for (size_t i = 0; i < members.size(); ++i)
+					localStep[members[i]] = g.adjlist[i]->cstep(); // disjoint for different components
+				compLatency[bySize[k]] = g.maxLatency;
+			}
+		};
+	vector<std::thread> pool;
+	for (int k = 1; k < threads; ++k)
+		pool.emplace_back(worker);
+	worker();
+	for (auto& th : pool)
+		th.join();
+	auto t2 = Clock::now();
+	print("Components scheduled in " + to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()) + " ns");
+
+	print("Begin merging the components...");
+	int maxCompLatency = *max_element(compLatency.begin(),compLatency.end());
+	vector<int> maxNr = resourceBound();
+	vector<int> first(maxCompLatency + 2);
+	auto merge = [&](bool alignEnd)
+		{
+			resetSchedule();
+			nrt.assign(1,typeNum); // nrt[0]
+			calendar.assign(typeNum);
+			// the step in the component (shifted to align the ends), which strictly increases along the edges,
+			// so the order by it (counting sort, the larger components first at a tie) is topological
+			auto target = [&](int v) { return localStep[v] + (alignEnd ? maxCompLatency - compLatency[compOf[v]] : 0); };
+			fill(first.begin(),first.end(),0);
+			for (int v = 0; v < vertex; ++v)
+				first[target(v) + 1]++;
+			for (size_t t = 1; t < first.size(); ++t)
+				first[t] += first[t-1];
+			order.resize(vertex);
+			for (auto c : bySize)
+				for (auto v : comp[c])
+					order[first[target(v)]++] = adjlist[v];
+			for (auto pnode = order.cbegin(); pnode != order.cend(); ++pnode)
+			{
+				int r = (*pnode)->rtype;
+				// asap() is the finish of the predecessors, as they are scheduled
+				int a = max(target((*pnode)->num),(*pnode)->asap());
+				int step = (maxNr[r] > 0 ? calendar.firstFree(r,a,(*pnode)->delay()) : a);
+				bookResource(*pnode,step,0,maxNr);
+			}
+			return make_pair(maxLatency,getTotalResources());
+		};
+	auto atEnd = merge(true);
+	bool alignEnd = (atEnd < merge(false)); // ties to the start
+	if (alignEnd)
+		merge(true);
+	print(string("Components aligned at their ") + (alignEnd ? "end" : "start"));
+	auto t3 = Clock::now();
+	print("Merging done!\n");
+	if (!QUIET)
+		cout << "Total time used: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t1).count() << " ns" << endl;
+	return true;
+}
@@ -9,107 +9,291 @@
 #define GRAPH_H
 
 #include<vector>
+#include<deque>
 #include<map>
+#include<unordered_map>
+#include<string>
+#include<string_view>
+#include<cstdint>
 #include<algorithm>
+#include<atomic>
 
 #define MAXINT_ 0x3f3f3f3f
 
+struct VNode;
+
+// a row of the CSR adjacency (see graph::buildCSR): the neighbours are indices into the node table (adjlist),
+// the iterators give the nodes
+struct VNodeRange
+{
+	const int* first = nullptr;
+	const int* last = nullptr;
+	VNode* const* table = nullptr;
+	struct const_iterator
+	{
+		const int* p;
+		VNode* const* table;
+		inline VNode* operator*() const { return table[*p]; }
+		inline const_iterator& operator++() { ++p; return *this; }
+		inline bool operator==(const const_iterator& it) const { return p == it.p; }
+		inline bool operator!=(const const_iterator& it) const { return p != it.p; }
+	};
+	inline const_iterator cbegin() const { return {first,table}; }
+	inline const_iterator cend() const { return {last,table}; }
+	inline const_iterator begin() const { return {first,table}; }
+	inline const_iterator end() const { return {last,table}; }
+	inline int size() const { return last - first; }
+	inline bool empty() const { return first == last; }
+	inline VNode* operator[](int i) const { return table[first[i]]; }
+};
+
+// per-node scheduling state, kept as parallel arrays indexed by VNode::num
+// so that the passes over all the nodes stream through memory
+struct NodeState
+{
+	// the default delay of an operation is 1
+	std::vector<int> delay;
+	// ASAP & ALAP value
+	std::vector<int> asap;
+	std::vector<int> alap;
+	// length of original time frame
+	std::vector<int> length;
+	// final results
+	std::vector<int> cstep;
+	inline void push(int _delay)
+	{
+		delay.push_back(_delay);
+		asap.push_back(1);
+		alap.push_back(MAXINT_);
+		length.push_back(0);
+		cstep.push_back(0);
+	}
+	inline void reserve(int n)
+	{
+		delay.reserve(n);
+		asap.reserve(n);
+		alap.reserve(n);
+		length.reserve(n);
+		cstep.reserve(n);
+	}
+	// back to the state right after reading, the delays are kept
+	inline void reset()
+	{
+		std::fill(asap.begin(),asap.end(),1);
+		std::fill(alap.begin(),alap.end(),MAXINT_);
+		std::fill(length.begin(),length.end(),0);
+		std::fill(cstep.begin(),cstep.end(),0);
+	}
+};
+
+// N_r(t) as a dense [step][type] matrix, stored row by row (one row of counters per control step)
+// with the peak of every type (max N_r(t)), kept up to date by a count of the steps at each level,
+// so that inc()/dec() are O(1), also when an op leaves the peak
+struct StepTable
+{
+	int types = 0;
+	std::vector<int> cell;
+	std::vector<int> peak;
+	std::vector<std::vector<int>> level; // level[type][n]: the number of steps with N_r(t) = n (n > 0)
+	inline void assign(int steps,int _types)
+	{
+		types = _types;
+		cell.assign((size_t)steps * types,0);
+		peak.assign(types,0);
+		level.resize(types);
+		for (auto& l : level)
+			l.assign(1,0);
+	}
+	inline void push_back() { cell.resize(cell.size() + types,0); } // append an empty step
+	inline int size() const { return types == 0 ? 0 : cell.size() / types; }
+	inline int* operator[](int step) { return cell.data() + (size_t)step * types; }
+	inline const int* operator[](int step) const { return cell.data() + (size_t)step * types; }
+	inline void inc(int step,int type)
+	{
+		int& n = cell[(size_t)step * types + type];
+		std::vector<int>& l = level[type];
+		l[n]--;
+		if (++n == (int)l.size())
+			l.push_back(0);
+		l[n]++;
+		if (n > peak[type])
+			peak[type] = n;
+	}
+	inline void dec(int step,int type)
+	{
+		int& n = cell[(size_t)step * types + type];
+		std::vector<int>& l = level[type];
+		l[n]--;
+		l[--n]++;
+		if (peak[type] > 0 && l[peak[type]] == 0) // the level below holds at least this step
+			peak[type]--;
+	}
+};
+
+// per-type calendar of the full control steps (N_r(t) has reached the resource constraint), one bit per step,
+// to find the first step with `len` consecutive free slots a word (64 steps) at a time
+// the steps past the end are free, the calendar grows geometrically when they are set
+struct ResourceCalendar
+{
+	std::vector<std::vector<uint64_t>> full; // full[type][word]
+	inline void assign(int types) { full.assign(types,std::vector<uint64_t>(1,0)); }
+	inline void set(int type,int t,bool isFull)
+	{
+		std::vector<uint64_t>& f = full[type];
+		if ((size_t)(t >> 6) >= f.size())
+			f.resize(std::max((size_t)(t >> 6) + 1,2 * f.size()),0);
+		if (isFull)
+			f[t >> 6] |= 1ULL << (t & 63);
+		else
+			f[t >> 6] &= ~(1ULL << (t & 63));
+	}
+	inline uint64_t freeWord(int type,size_t w) const
+		{ return w < full[type].size() ? ~full[type][w] : ~0ULL; }
+	// first step t >= a with the steps t .. t+len-1 all free (len <= 64)
+	int firstFree(int type,int a,int len) const
+	{
+		for (size_t w = a >> 6; ; ++w)
+		{
+			uint64_t cur = freeWord(type,w), next = freeWord(type,w + 1), m = cur;
+			for (int k = 1; k < len; ++k) // bit i of m: steps i .. i+k all free
+				m &= (cur >> k) | (next << (64 - k));
+			if (w == (size_t)(a >> 6))
+				m &= ~0ULL << (a & 63);
+			if (m != 0)
+				return (int)(w << 6) + __builtin_ctzll(m);
+		}
+	}
+};
+
+// the fields used by the traversals are put together at the front (one cache line)
 struct VNode
 {
 	int num;
-	std::string name;
-	std::string type;
-	// the default delay of an operation is 1
-	int delay = 1;
+	// resource type id (see graph::internType)
+	int rtype;
 	// the number of incoming edges
 	int incoming = 0;
 	// temporary number of incoming edges (used for topo)
 	int tempIncoming = 0;
 	// for easily reading info of its predecessors and successors
-	// the nodes are stored in a adjcent list
-	std::vector<VNode*> pred;
-	std::vector<VNode*> succ;
-	// ASAP & ALAP value
-	int asap = 1;
-	int alap = MAXINT_;
-	// length of original time frame
-	int length = 0;
-	// final results
-	int cstep = 0;
+	// views of the CSR adjacency owned by the graph
+	VNodeRange pred;
+	VNodeRange succ;
+	// scheduling state owned by the graph
+	NodeState* st;
 	bool criticalPath = false;
-	VNode(int _num,std::string _name,std::string _type,int _delay = 1):
-		num(_num),name(_name),type(_type),delay(_delay){};
+	std::string name;
+	std::string type;
+	VNode(int _num,int _rtype,std::string _name,std::string _type,NodeState* _st):
+		num(_num),rtype(_rtype),st(_st),name(_name),type(_type){};
+	inline int& delay() const { return st->delay[num]; }
+	inline int& asap() const { return st->asap[num]; }
+	inline int& alap() const { return st->alap[num]; }
+	inline int& length() const { return st->length[num]; }
+	inline int& cstep() const { return st->cstep[num]; }
 	inline void setASAP(int _asap)
 	{
-		asap = std::max(asap,_asap);
+		asap() = std::max(asap(),_asap);
 	}
 	inline void setALAP(int _alap)
 	{
-		alap = std::min(alap,_alap);
+		alap() = std::min(alap(),_alap);
 	}
 	inline void extendALAP(int _alap)
 	{
-		alap = _alap;
+		alap() = _alap;
 	}
 	inline void setLength() // this function should be called as soon as topo sorting has been implemented
 	{
-		length = alap - asap + 1;
+		length() = alap() - asap() + 1;
 	}
 	inline int getLength()
 	{
-		return alap - asap + 1;
+		return alap() - asap() + 1;
 	}
 	void schedule(int step)
 	{
-		cstep = step;
+		cstep() = step;
 		for (auto pnode = succ.cbegin(); pnode != succ.cend(); ++pnode) // updown behavior
-			(*pnode)->setASAP(step + delay);
+			(*pnode)->setASAP(step + delay());
 	}
 	void scheduleBackward(int step)
 	{
-		cstep = step;
+		cstep() = step;
 		for (auto pnode = pred.cbegin(); pnode != pred.cend(); ++pnode)
-			(*pnode)->setALAP(step - (*pnode)->delay);
-	}
-	void scheduleAll(int step) // mainly for FDS
-	{
-		cstep = step;
-		iterativeSetASAP(step);
-		iterativeSetALAP(step);
-		setLength();
-	}
-	void iterativeSetASAP(int step)
-	{
-		for (auto pnode = succ.cbegin(); pnode != succ.cend(); ++pnode)
-			(*pnode)->iterativeSetASAP(step + delay);
-		setASAP(step);
-	}
-	void iterativeSetALAP(int step)
-	{
-		for (auto pnode = pred.cbegin(); pnode != pred.cend(); ++pnode)
-			(*pnode)->iterativeSetALAP(step - (*pnode)->delay);
-		setALAP(step);
+			(*pnode)->setALAP(step - (*pnode)->delay());
 	}
 	bool testValid(int step)
 	{
 		for (auto pnode = succ.cbegin(); pnode != succ.cend(); ++pnode)
-			if (step + delay >= (*pnode)->cstep)
+			if (step + delay() >= (*pnode)->cstep())
 				return false;
 		for (auto pnode = pred.cbegin(); pnode != pred.cend(); ++pnode)
-			if ((*pnode)->cstep + (*pnode)->delay >= step)
+			if ((*pnode)->cstep() + (*pnode)->delay() >= step)
 				return false;
 		return true;
 	}
 };
 
+// the data of the priority policies of list scheduling other than the time frames (see graph::listContext)
+struct ListContext
+{
+	// only filled if the policy needs them
+	std::vector<int> level; // number of ops on the longest path to a sink (the op included)
+	std::vector<double> force; // self force of the op at its ASAP
+};
+
+// priority policies of list scheduling, the template parameter of graph::TC_LS/RC_LS:
+// the op with the least key goes first, the ties go to the node number
+// the key is taken when the op becomes ready (RC) or before the placement (TC)
+struct ALAPPriority // the ALAP step, i.e. the latest start
+{
+	static constexpr const char* name = "ALAP";
+	static constexpr bool needsLevel = false, needsForce = false;
+	static inline double key(const VNode* v,const ListContext&) { return v->alap(); }
+};
+struct MobilityPriority
+{
+	static constexpr const char* name = "mobility";
+	static constexpr bool needsLevel = false, needsForce = false;
+	static inline double key(const VNode* v,const ListContext&) { return v->alap() - v->asap(); }
+};
+struct PathPriority // the longest path to a sink in ops (Hu's level)
+{
+	static constexpr const char* name = "path";
+	static constexpr bool needsLevel = true, needsForce = false;
+	static inline double key(const VNode* v,const ListContext& ctx) { return -ctx.level[v->num]; }
+};
+struct SuccessorPriority
+{
+	static constexpr const char* name = "successors";
+	static constexpr bool needsLevel = false, needsForce = false;
+	static inline double key(const VNode* v,const ListContext&) { return -v->succ.size(); }
+};
+struct ForcePriority
+{
+	static constexpr const char* name = "force";
+	static constexpr bool needsLevel = false, needsForce = true;
+	static inline double key(const VNode* v,const ListContext& ctx) { return ctx.force[v->num]; }
+};
+
 class graph
 {
 public:
 	graph() = default;
-	~graph();
+	// the nodes point into the graph's own storage, a copy rebinds them to its own
+	// the edges of the copy are reversed if flip is set (as if read in the other order)
+	graph(const graph& g,bool flip = false);
+	// the subgraph induced by some nodes of g (see scheduleComponents)
+	graph(const graph& g,const std::vector<int>& members,const std::vector<int>& local);
+	graph& operator=(const graph&) = delete;
 
 	// read from dot file
 	void readFile(std::ifstream& infile);
+	bool readFile(const char* path); // memory-mapped, returns false if the file cannot be opened
+	// binary graph cache (.edsg) used by readFile(path)
+	bool readCache(const char* path);
+	void writeCache(const char* path) const;
 
 	// output
 	void printAdjlist() const;
@@ -120,20 +304,29 @@ public:
 	void TC_EDS (int order_mode = 0);
 	void TC_IEDS(int order_mode = 0);
 	// EDS for resource-constrained scheduling problems
-	void RC_EDS ();
+	void RC_EDS (int order_mode = 0);
 	void RC_IEDS();
+	// multi-start EDS, the variants are scheduled concurrently and the best schedule is kept
+	void portfolioEDS(int threads = 0);
+	// RC_EDS of the weakly connected components on their own, merged under the shared constraints
+	bool scheduleComponents(int threads = 0);
 
 	// Force-directed scheduling for time-constrained problems
-	void TC_FDS();
+	// the forces are evaluated on a pool of threads, 0 for all the cores
+	bool TC_FDS(int threads = 0); // false if some op has no feasible step left
 	// Force-directed scheduling for resource-constrained problems
-	void RC_FDS();
+	void RC_FDS(int threads = 0);
 
 	// List scheduling for time-constrained problems
-	void TC_LS();
-	void RC_LS();
+	// the ready ops are ranked by a priority policy (see ALAPPriority), inlined in the scheduler
+	template <class Priority = ALAPPriority> void TC_LS();
+	template <class Priority = ALAPPriority> void RC_LS();
+	// every priority policy of LS on a copy of the graph, reported side by side, the best schedule is kept
+	void comparePriorities();
 
 	// test
 	bool testFeasibleSchedule() const;
+	bool testTopologicalOrder() const;
 
 	// ILP formulation
 	void generateRC_ILP(std::ofstream& outfile);
@@ -146,33 +339,82 @@ public:
 	inline void setMAXRESOURCE(const std::map<std::string,int> gr)
 		{ MAXRESOURCE = gr; };
 	inline void setPRINT(int mode) { if (mode == 0) PRINT = false; };
+	inline void setCACHE(int mode) { CACHE = (mode != 0); };
+	// schedule the weakly connected components on their own and merge them (see scheduleComponents),
+	// only for RC EDS, IEDS, FDS and LS (MODE 10, 11, 13, 14) on a graph of more than one component,
+	// otherwise the graph is scheduled as a whole and a message says so
+	inline void setSPLIT(int mode) { SPLIT = (mode != 0); };
+	inline void setCHECK(int mode) { CHECK = (mode != 0); }; // cross-check the incremental structures (slow)
+	inline void setMoveBudget(int budget) { moveBudget = budget; }; // fine-tuning moves of IEDS, 0 for no limit
+	// portfolio EDS (MODE 5 / 15): the number of variants and the seed of their random tie-breaks
+	// the winner is scheduled on this graph: if its direction differs from the MODE given, the edges stay reversed
+	// and the scheduling order in MODE (MODE[1] for RC, MODE[2] for TC) is flipped for the rest of its life
+	inline void setPortfolio(int variants,unsigned _seed) { portfolioSize = variants; seed = _seed; };
 	inline double getLC() const {return LC;};
 	inline int getMaxLatency() const {return maxLatency;};
+	inline int getConstrainedLatency() const {return ConstrainedLatency;};
+	inline const std::vector<int>& getSchedule() const {return ns.cstep;}; // the step of every node by number
+	inline int getTotalResources() const // the sum of max N_r(t) over the types
+		{ int sum_r = 0; for (int r = 0; r < typeNum; ++r) sum_r += nrt.peak[r]; return sum_r; };
+
+	// clear the last schedule so that the graph can be scheduled again without reading it
+	void resetSchedule();
+
+	// topological ordering and time frames (ASAP & ALAP)
+	// order_mode 0 DFS order, 1 sorted by ALAP & ASAP, 2 sorted by ASAP; the ties are broken randomly if tieSeed is set
+	void topologicalSortingDFS(int order_mode = 0);
+	void topologicalSortingKahn();
+	void topologicalSortingLevel(int threads = 0); // level-parallel, 0 threads for all the cores
 
 private:
 	// initialization
 	void initialize();
 	void clearMark();
 	void setDegrees(); // in-degree or out-degree
-	void addVertex(const std::string name,const std::string type);
-	bool addEdge(const std::string vFrom,const std::string vTo);
-	VNode* findVertex(const std::string name) const;
+	void parseDot(const char* p,const char* end);
+	void buildCSR();
+	void reverseEdges();
+	void rankNodes();
+	std::vector<std::vector<int>> weakComponents() const;
+	bool loadCache(const char* buf,size_t size,uint64_t dotSize,int64_t dotMtime);
+	inline bool isTopDown() const
+		{ return (MODE.size() == 2 && MODE[1] == 0) || (MODE.size() > 2 && MODE[2] == 1); };
+	void addVertex(std::string_view name,std::string_view type);
+	bool addEdge(std::string_view vFrom,std::string_view vTo);
+	void addArc(int from,int to);
+	void indexVertex(VNode* const& v);
+	VNode* findVertex(std::string_view name) const;
 	inline std::string mapResourceType(const std::string type) const;
+	int internType(const std::string& type);
+	void sortTypes();
+	std::vector<int> resourceBound();
 
 	// preparation
-	void topologicalSortingDFS(bool aslap_order = false);
-	void topologicalSortingKahn();
 	void dfsASAP(VNode* const& node);
 	void dfsALAP(VNode* const& node);
+	void setLatencyConstraint();
+	inline void pullALAP(VNode* const& node);
 
 	// scheduling
 	void placeCriticalPath();
+	void placeFirstFit(const std::vector<int>& maxNr);
+	void bookResource(VNode* const& node,int step,int mode,const std::vector<int>& maxNr);
+	void fineTuning();
 	bool scheduleNodeStep(VNode* const& node,int step,int mode);
 	bool newScheduleNodeStep(VNode* const& node,int step);
 	bool scheduleNodeStepResource(VNode* const& node,int step,int mode);
-	double calForce(int a,int b,int na,int nb,const std::vector<double>& DG,int delay) const;
-	double calPredForce(VNode* const& v,int cstep,const std::map<std::string,std::vector<double>>& DG) const;
-	double calSuccForce(VNode* const& v,int cstep,const std::map<std::string,std::vector<double>>& DG) const;
+	int scheduleAll(VNode* const& node,int step);
+	void buildDG(std::vector<std::vector<double>>& DG) const;
+	void addDG(std::vector<std::vector<double>>& DG,int v,int a,int b,double sign) const;
+	void checkDG(const std::vector<std::vector<double>>& DG) const;
+	void prefixDG(const std::vector<std::vector<double>>& DG,std::vector<std::vector<double>>& DGsum) const;
+	void newForceVersion();
+	double calForce(int a,int b,int na,int nb,const std::vector<double>& DGsum,int delay) const;
+	void listContext(ListContext& ctx,bool level,bool force) const;
+	template <class Priority> void runLS();
+	double calPredForce(VNode* const& v,int cstep,const std::vector<std::vector<double>>& DGsum);
+	double calSuccForce(VNode* const& v,int cstep,const std::vector<std::vector<double>>& DGsum);
+	double calTotalForce(VNode* const& v,int cstep,const std::vector<std::vector<double>>& DGsum);
 
 	// output
 	void standardOutput() const;
@@ -198,34 +440,76 @@ private:
 
 	// Use adjacent list to store the graph
 	std::vector<VNode*> adjlist;
+	// storage of the nodes in adjlist, allocated in chunks (stable addresses) and freed at once
+	std::deque<VNode> nodes;
+	// scheduling state of the nodes in adjlist
+	NodeState ns;
+	// edges (in scheduling direction) collected while reading, turned into CSR by buildCSR()
+	std::vector<std::pair<int,int>> arcs;
+	// CSR adjacency: the successors of node i are succList[succOffset[i] .. succOffset[i+1]), viewed by VNode::pred/succ
+	std::vector<int> succOffset, succList;
+	std::vector<int> predOffset, predList;
+	// topological rank of the nodes and its inverse, and the worklist of scheduleAll
+	std::vector<int> topoRank, byRank;
+	std::vector<int> frontier;
+	std::vector<char> queued;
+	// nodes touched by the time frame propagation, and the number of propagations (placements)
+	long long numTouched = 0;
+	int numPropagation = 0;
+	// nodes whose time frame has been tightened by scheduleAll (only collected if trackFrames), cleared by the user
+	bool trackFrames = false;
+	std::vector<int> tightened;
+	// forces of calSuccForce/calPredForce memoized by (node, direction, step), valid if stamped with the version of DG
+	// shared by the threads evaluating the forces (the value is stored before the stamp)
+	std::vector<std::atomic<double>> forceMemo;
+	std::vector<std::atomic<int>> forceStamp;
+	int memoWidth = 0;
+	int dgVersion = 0;
+	// name -> index in adjlist
+	std::vector<int> denseIndex; // integer names
+	std::unordered_map<std::string_view,int> nameIndex; // other names, viewing VNode::name
 	// mark for DFS-based topological sorting and list scheduling
 	std::vector<int> mark;
+	// explicit stack of dfsASAP/dfsALAP: node and the next neighbour to visit
+	std::vector<std::pair<VNode*,int>> dfsStack;
 	// topological ordering
 	std::vector<VNode*> order;
 	// ordering without operations on critical path
 	std::vector<VNode*> edsOrder;
 
+	// resource types, numbered in name order after reading (see sortTypes)
+	std::map<std::string,int> typeIndex;
+	std::vector<std::string> typeName;
 	// N_r
-	std::map<std::string,int> nr;
-	std::map<std::string,int> r_delay;
-	std::map<std::string,std::vector<int>> TFcount;
-	// N_r(t)
-	std::vector<std::map<std::string,int>> nrt;
-	// max N_r(t)
-	std::map<std::string,int> maxNrt;
+	std::vector<int> nr;
+	std::vector<int> r_delay;
+	std::vector<std::vector<int>> TFcount; // type step count
+	// N_r(t), and max N_r(t) in nrt.peak
+	StepTable nrt;
+	// full steps of the resource-constrained schedulers
+	ResourceCalendar calendar;
 
 	// variables used for generating ILP
 	std::vector<std::vector<int>> ilp;
-	std::map<int,std::map<std::string,std::vector<int>>> rowResource; // step type ops
+	std::map<int,std::map<int,std::vector<int>>> rowResource; // step type ops
 
 	// latency factor
 	double LC = 1;
-	int ConstrainedLatency;
+	int ConstrainedLatency = 0;
 	// for resource-constrained scheduling
 	std::map<std::string,int> MAXRESOURCE;
 
 	std::vector<int> MODE;
 	bool PRINT = true;
+	bool CACHE = true;
+	bool SPLIT = false;
+	bool CHECK = false;
+	bool QUIET = false; // no timing output (the copies scheduled by portfolioEDS and scheduleComponents)
+	int moveBudget = 0;
+	// multi-start EDS: number of variants and the seed of their random tie-breaks
+	int portfolioSize = 10;
+	unsigned seed = 1;
+	unsigned tieSeed = 0; // 0 for the deterministic order
 };
 
 #endif // GRAPH_H
\ No newline at end of file
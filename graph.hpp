@@ -17,28 +17,38 @@
 
 #include "graph.h"
 #include "initialization.hpp"
+#include "cache.hpp"
 #include "topological_sorting.hpp"
 #include "output.hpp"
 #include "ILP.hpp"
 #include "FDS.hpp"
 #include "LS.hpp"
 #include "EDS.hpp"
+#include "component.hpp"
 using namespace std;
 
 void graph::mainScheduling(int mode)
 {
-	switch (MODE[0])
-	{
-		case 0: TC_EDS(0);break;
-		case 1: TC_IEDS(0);break;
-		case 3: TC_FDS();break;
-		case 4: TC_LS();break;
-		case 10: RC_EDS();break;
-		case 11: RC_IEDS();break;
-		case 13: RC_FDS();break;
-		case 14: RC_LS();break;
-		default: cout << "Invaild mode!" << endl;return;
-	}
+	if (!SPLIT || !scheduleComponents()) // the weakly connected components on their own if asked (and possible)
+		switch (MODE[0])
+		{
+			case 0: TC_EDS(0);break;
+			case 1: TC_IEDS(0);break;
+			case 3: if (!TC_FDS()) return;break; // no schedule to output
+			case 4: TC_LS();break;
+			case 5: portfolioEDS();break;
+			case 6: comparePriorities();break;
+			case 10: RC_EDS();break;
+			case 11: RC_IEDS();break;
+			case 13: RC_FDS();break;
+			case 14: RC_LS();break;
+			case 15: portfolioEDS();break;
+			case 16: comparePriorities();break;
+			default: cout << "Invaild mode!" << endl;return;
+		}
+	if (numPropagation > 0)
+		print("Time frame propagation: " + to_string(numTouched) + " nodes touched in "
+			+ to_string(numPropagation) + " placements (" + to_string((double)numTouched / numPropagation) + " per placement)");
 	if (mode == 0)
 		standardOutput();
 	else
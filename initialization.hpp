@@ -5,104 +5,487 @@
 
 // This file contains the implementation of the graph initialization part.
 
-#include <regex> // regular expression for string split
 #include <fstream>
+#include <cctype>
+#include <string_view>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 using namespace std;
 
-// for string split
-std::vector<std::string> split(const std::string& input, const std::string& regex);
-
-graph::~graph()
+void graph::resetSchedule()
 {
+	ns.reset();
 	for (auto node : adjlist)
-		delete node;
+		node->criticalPath = false;
+	// clear() and assign() keep the capacity, so rescheduling does not allocate again
+	nrt.assign(0,typeNum);
+	order.clear();
+	edsOrder.clear();
+	rowResource.clear();
+	numScheduledOp = 0;
+	maxLatency = 0;
+	cdepth = 0;
+	numPropagation = 0;
+	numTouched = 0;
+	clearMark();
 }
 
 void graph::clearMark()
 {
-	mark.clear();
-	for (int i = 0; i < vertex; ++i)
-		mark.push_back(0);
+	mark.assign(vertex,0);
 }
 
 void graph::initialize()
 {
 	print("Begin initializing...");
+	sortTypes();
+	buildCSR();
+	rankNodes();
 	clearMark();
 	print("Initialized successfully!\n");
 }
 
+// build the CSR adjacency from the collected arcs (unless it has been loaded from a cache)
+// and bind the pred/succ views of the nodes
+// counting sort keeps the insertion order of the arcs in every row
+void graph::buildCSR()
+{
+	if (succOffset.size() != (size_t)vertex + 1)
+	{
+		succOffset.assign(vertex + 1,0);
+		predOffset.assign(vertex + 1,0);
+		for (auto arc : arcs)
+		{
+			succOffset[arc.first + 1]++;
+			predOffset[arc.second + 1]++;
+		}
+		for (int i = 0; i < vertex; ++i)
+		{
+			succOffset[i + 1] += succOffset[i];
+			predOffset[i + 1] += predOffset[i];
+		}
+		succList.resize(arcs.size());
+		predList.resize(arcs.size());
+		vector<int> spos(succOffset.begin(),succOffset.end() - 1), ppos(predOffset.begin(),predOffset.end() - 1);
+		for (auto arc : arcs)
+		{
+			succList[spos[arc.first]++] = arc.second;
+			predList[ppos[arc.second]++] = arc.first;
+		}
+	}
+	vector<pair<int,int>>().swap(arcs);
+	for (int i = 0; i < vertex; ++i)
+	{
+		VNode* v = adjlist[i];
+		v->succ = {succList.data() + succOffset[i],succList.data() + succOffset[i + 1],adjlist.data()};
+		v->pred = {predList.data() + predOffset[i],predList.data() + predOffset[i + 1],adjlist.data()};
+	}
+}
+
+// reverse all the edges, i.e. swap the two CSR directions and the scheduling order
+// the result is the same graph as read in the other order (see addEdge)
+void graph::reverseEdges()
+{
+	bool topdown = !isTopDown();
+	if (MODE.size() > 2)
+		MODE[2] = (topdown ? 1 : 0);
+	else
+	{
+		MODE.resize(2,0);
+		MODE[1] = (topdown ? 0 : 1);
+	}
+	swap(succOffset,predOffset);
+	swap(succList,predList);
+	buildCSR();
+	rankNodes();
+	clearMark();
+}
+
+// copy a graph after reading, the nodes, their views of the CSR and the orders are rebound to the copy
+graph::graph(const graph& g,bool flip):
+	vertex(g.vertex), edge(g.edge), typeNum(g.typeNum), numScheduledOp(g.numScheduledOp),
+	MUL_DELAY(g.MUL_DELAY), cdepth(g.cdepth), maxLatency(g.maxLatency), ns(g.ns),
+	succOffset(g.succOffset), succList(g.succList), predOffset(g.predOffset), predList(g.predList),
+	topoRank(g.topoRank), byRank(g.byRank), queued(g.queued), numTouched(g.numTouched), numPropagation(g.numPropagation),
+	denseIndex(g.denseIndex), mark(g.mark), typeIndex(g.typeIndex), typeName(g.typeName), nr(g.nr), r_delay(g.r_delay),
+	TFcount(g.TFcount), nrt(g.nrt), calendar(g.calendar), ilp(g.ilp), rowResource(g.rowResource),
+	LC(g.LC), ConstrainedLatency(g.ConstrainedLatency), MAXRESOURCE(g.MAXRESOURCE), MODE(g.MODE),
+	PRINT(g.PRINT), CACHE(g.CACHE), SPLIT(g.SPLIT), CHECK(g.CHECK), QUIET(g.QUIET), moveBudget(g.moveBudget),
+	portfolioSize(g.portfolioSize), seed(g.seed), tieSeed(g.tieSeed)
+{
+	adjlist.reserve(vertex);
+	for (auto node : g.adjlist)
+	{
+		nodes.emplace_back(node->num,node->rtype,node->name,node->type,&ns);
+		VNode* v = &nodes.back();
+		v->incoming = node->incoming;
+		v->tempIncoming = node->tempIncoming;
+		v->criticalPath = node->criticalPath;
+		adjlist.push_back(v);
+	}
+	for (auto pidx = g.nameIndex.cbegin(); pidx != g.nameIndex.cend(); ++pidx)
+		nameIndex.insert(make_pair(string_view(adjlist[pidx->second]->name),pidx->second));
+	for (auto node : g.order)
+		order.push_back(adjlist[node->num]);
+	for (auto node : g.edsOrder)
+		edsOrder.push_back(adjlist[node->num]);
+	if (flip)
+		reverseEdges(); // rebinds the views as well
+	else
+		buildCSR();
+}
+
 // read from dot file
 void graph::readFile(ifstream& infile)
 {
-	string str;
-	// The first two lines in dot file are useless info
-	getline(infile,str);
-	getline(infile,str);
+	// slurp the whole file once, the tokenizer below works on a flat buffer
+	string buf;
+	infile.seekg(0,ios::end);
+	streamoff size = infile.tellg();
+	infile.seekg(0,ios::beg);
+	if (size > 0)
+	{
+		buf.resize(size);
+		infile.read(&buf[0],size);
+		buf.resize(infile.gcount());
+	}
+	else
+		buf.assign(istreambuf_iterator<char>(infile),istreambuf_iterator<char>());
 	print("Begin parsing...");
-	// operation nodes info
-	while (getline(infile,str) && str.find("-") == std::string::npos)
-	{
-		vector<string> op = split(str," *\\[ *label *= *| *\\];| +"); // reg exp
-		addVertex(op[1],op[2]); // op[0] = ""
-	}
-	// edges info
-	do {
-		vector<string> arc = split(str," *\\[ *name *= *| *\\];| *-> *| +"); // reg exp
-		if (!addEdge(arc[1],arc[2]))
-			cout << "Add edge wrong!" << endl;
-	} while (getline(infile,str) && str.size() > 1);
+	parseDot(buf.data(),buf.data() + buf.size());
 	print("Parsed dot file successfully!\n");
 	initialize();
 }
 
-void graph::addVertex(const string name,const string type)
+// read from dot file without copying it
+// the file is mapped into memory and the tokens are views of the mapping,
+// only node names and types are copied (once) into the graph
+bool graph::readFile(const char* path)
 {
+	if (CACHE && readCache(path))
+	{
+		initialize();
+		return true;
+	}
+#if defined(__unix__) || defined(__APPLE__)
+	int fd = open(path,O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd,&st) < 0)
+	{
+		close(fd);
+		return false;
+	}
+	size_t size = st.st_size;
+	void* buf = (size > 0 ? mmap(nullptr,size,PROT_READ,MAP_PRIVATE,fd,0) : MAP_FAILED);
+	close(fd);
+	if (size > 0 && buf == MAP_FAILED)
+		return false;
+	print("Begin parsing...");
+	if (size > 0)
+	{
+		madvise(buf,size,MADV_SEQUENTIAL);
+		parseDot((const char*)buf,(const char*)buf + size);
+		munmap(buf,size);
+	}
+	print("Parsed dot file successfully!\n");
+	initialize();
+	if (CACHE)
+		writeCache(path);
+	return true;
+#else
+	ifstream infile(path,ios::binary);
+	if (!infile)
+		return false;
+	readFile(infile);
+	return true;
+#endif
+}
+
+// ---------------- DOT tokenizer ----------------
+// Only the subset of DOT used by ExPRESS is supported, i.e.
+//     name [label = type];
+//     from -> to [name = id];
+// Graph headers and default attribute statements (node/edge/graph [...]) are skipped.
+
+static inline bool isDotIdChar(char c)
+{
+	return isalnum((unsigned char)c) || c == '_' || c == '.';
+}
+
+// skip white spaces and comments
+static const char* skipDotBlank(const char* p,const char* end)
+{
+	while (p < end)
+	{
+		if (isspace((unsigned char)*p))
+			++p;
+		else if (*p == '/' && p + 1 < end && p[1] == '/') // line comment
+			while (p < end && *p != '\n')
+				++p;
+		else if (*p == '#') // preprocessor-like line
+			while (p < end && *p != '\n')
+				++p;
+		else if (*p == '/' && p + 1 < end && p[1] == '*') // block comment
+		{
+			p += 2;
+			while (p + 1 < end && !(p[0] == '*' && p[1] == '/'))
+				++p;
+			p = min(p + 2,end);
+		}
+		else
+			break;
+	}
+	return p;
+}
+
+// read an identifier (or a quoted string)
+static const char* readDotId(const char* p,const char* end,string_view& id)
+{
+	id = string_view();
+	if (p >= end)
+		return p;
+	const char* b = p;
+	if (*p == '"')
+	{
+		b = ++p;
+		while (p < end && *p != '"')
+			p += (*p == '\\' && p + 1 < end ? 2 : 1);
+		p = min(p,end);
+		id = string_view(b,p - b);
+		return min(p + 1,end);
+	}
+	if (*p == '-' && !(p + 1 < end && p[1] == '>')) // negative numeral
+		++p;
+	while (p < end && isDotIdChar(*p))
+		++p;
+	id = string_view(b,p - b);
+	return p;
+}
+
+// parse an attribute list [k1 = v1, k2 = v2; ...] and return the value of key
+static const char* readDotAttr(const char* p,const char* end,string_view key,string_view& val,bool& found)
+{
+	found = false;
+	p = skipDotBlank(p,end);
+	if (p >= end || *p != '[')
+		return p;
+	++p;
+	while (true)
+	{
+		p = skipDotBlank(p,end);
+		if (p >= end)
+			return p;
+		if (*p == ']')
+			return p + 1;
+		if (*p == ',' || *p == ';')
+		{
+			++p;
+			continue;
+		}
+		string_view k;
+		p = readDotId(p,end,k);
+		if (k.empty()) // unexpected character
+		{
+			++p;
+			continue;
+		}
+		p = skipDotBlank(p,end);
+		if (p < end && *p == '=')
+		{
+			string_view v;
+			p = readDotId(skipDotBlank(p + 1,end),end,v);
+			if (k == key)
+			{
+				val = v;
+				found = true;
+			}
+		}
+	}
+}
+
+void graph::parseDot(const char* p,const char* end)
+{
+	while ((p = skipDotBlank(p,end)) < end)
+	{
+		if (*p == '{' || *p == '}' || *p == ';' || *p == ',')
+		{
+			++p;
+			continue;
+		}
+		string_view a, val;
+		bool found;
+		p = readDotId(p,end,a);
+		if (a.empty()) // unknown character, drop the rest of the line
+		{
+			while (p < end && *p != '\n')
+				++p;
+			continue;
+		}
+		if (a == "strict")
+			continue;
+		if (a == "digraph" || a == "graph" || a == "subgraph" || a == "node" || a == "edge")
+		{
+			p = skipDotBlank(p,end);
+			if (p < end && *p == '[') // default attributes
+				p = readDotAttr(p,end,"",val,found);
+			else // graph name
+				p = readDotId(p,end,val);
+			continue;
+		}
+		p = skipDotBlank(p,end);
+		if (p + 1 < end && p[0] == '-' && p[1] == '>') // edge statement (chains are allowed)
+		{
+			while (p + 1 < end && p[0] == '-' && p[1] == '>')
+			{
+				string_view b;
+				p = readDotId(skipDotBlank(p + 2,end),end,b);
+				if (!addEdge(a,b))
+					cout << "Add edge wrong!" << endl;
+				a = b;
+				p = skipDotBlank(p,end);
+			}
+			p = readDotAttr(p,end,"",val,found);
+		}
+		else // node statement
+		{
+			p = readDotAttr(p,end,"label",val,found);
+			if (!found)
+			{
+				cout << "Add vertex wrong!" << endl;
+				continue;
+			}
+			addVertex(a,val);
+		}
+	}
+}
+
+void graph::addVertex(string_view name,string_view type_)
+{
+	string type(type_);
+	int rtype = internType(mapResourceType(type));
 	int delay = 1;
 	// set MUL delay
-	if (mapResourceType(type) == "MUL")
+	if (typeName[rtype] == "MUL")
 		delay = MUL_DELAY;
 	// be careful of the numbers!!! start labeling from 0
-	VNode* v = new VNode(vertex++,name,type,delay);
+	ns.push(delay);
+	nodes.emplace_back(vertex++,rtype,string(name),type,&ns);
+	VNode* v = &nodes.back();
 	adjlist.push_back(v);
-	if (nr.find(mapResourceType(type)) != nr.end()) // exist
-		nr[mapResourceType(type)]++;
-	else
+	indexVertex(v);
+	nr[rtype]++;
+}
+
+// resource type -> small integer id, so that the schedulers index dense arrays instead of string maps
+int graph::internType(const string& type)
+{
+	auto ptype = typeIndex.find(type);
+	if (ptype != typeIndex.end()) // exist
+		return ptype->second;
+	typeIndex[type] = typeNum;
+	typeName.push_back(type);
+	nr.push_back(0);
+	r_delay.push_back(type == "MUL" ? MUL_DELAY : 1);
+	return typeNum++;
+}
+
+// renumber the types in name order (the ids are given in order of appearance while reading),
+// so that the loops over the types visit them in the same order as the former std::map did
+void graph::sortTypes()
+{
+	vector<int> rank(typeNum);
+	int k = 0;
+	for (auto ptype = typeIndex.begin(); ptype != typeIndex.end(); ++ptype, ++k)
 	{
-		typeNum++;
-		nr[mapResourceType(type)] = 1;
-		r_delay[mapResourceType(type)] = mapResourceType(type) == "MUL" ? MUL_DELAY : 1;
-		maxNrt[mapResourceType(type)] = 0;
+		rank[ptype->second] = k;
+		ptype->second = k;
 	}
+	vector<int> count(typeNum);
+	for (int t = 0; t < typeNum; ++t)
+		count[rank[t]] = nr[t];
+	nr = count;
+	for (auto ptype = typeIndex.cbegin(); ptype != typeIndex.cend(); ++ptype)
+	{
+		typeName[ptype->second] = ptype->first;
+		r_delay[ptype->second] = (ptype->first == "MUL" ? MUL_DELAY : 1);
+	}
+	for (auto node : adjlist)
+		node->rtype = rank[node->rtype];
+}
+
+// resource constraints indexed by type id (a type missing in MAXRESOURCE is constrained to 0, as before)
+vector<int> graph::resourceBound()
+{
+	vector<int> bound(typeNum);
+	for (int t = 0; t < typeNum; ++t)
+		bound[t] = MAXRESOURCE[typeName[t]];
+	return bound;
 }
 
-bool graph::addEdge(const string vFrom,const string vTo)
+bool graph::addEdge(string_view vFrom,string_view vTo)
 {
 	VNode* vf = findVertex(vFrom);
 	VNode* vt = findVertex(vTo);
 	if (vf == nullptr || vt == nullptr)
 		return false;
-	if ((MODE.size() == 2 && MODE[1] == 0) || (MODE.size() > 2 && MODE[2] == 1)) // top-down behavior
-	{
-		vf->succ.push_back(vt);
-		vt->pred.push_back(vf);
-	}
+	addArc(vf->num,vt->num);
+	return true;
+}
+
+// the edge from -> to of the dot file (also read back from the cache in file order)
+void graph::addArc(int from,int to)
+{
+	if (isTopDown()) // top-down behavior
+		arcs.push_back(make_pair(from,to));
 	else // bottom-up behavior
-	{
-		vt->succ.push_back(vf);
-		vf->pred.push_back(vt);
-	}
+		arcs.push_back(make_pair(to,from));
 	edge++;
-	vector<int> cons = {vf->num,vt->num,(-1)*vf->delay};
+	vector<int> cons = {from,to,(-1)*ns.delay[from]};
 	ilp.push_back(cons);
-	return true;
 }
 
-VNode* graph::findVertex(const string name) const
+// names like "17" (hal.dot, dag_*.dot) are directly used as indices
+static inline int denseVertexId(string_view name)
 {
-	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
-		if ((*pnode)->name == name)
-			return (*pnode);
+	if (name.empty() || name.size() > 9 || (name[0] == '0' && name.size() > 1))
+		return -1;
+	int id = 0;
+	for (auto c : name)
+		if (c >= '0' && c <= '9')
+			id = id * 10 + (c - '0');
+		else
+			return -1;
+	return id;
+}
+
+void graph::indexVertex(VNode* const& v)
+{
+	int id = denseVertexId(v->name);
+	if (id >= 0 && id <= 2 * vertex + 1024) // avoid huge sparse tables
+	{
+		if ((size_t)id >= denseIndex.size())
+			denseIndex.resize(max(2 * denseIndex.size(),(size_t)id + 1),-1);
+		if (denseIndex[id] == -1) // keep the first one if names are duplicated
+			denseIndex[id] = v->num;
+	}
+	else
+		nameIndex.insert(make_pair(string_view(v->name),v->num)); // views the name owned by the node
+}
+
+VNode* graph::findVertex(string_view name) const
+{
+	int id = denseVertexId(name);
+	if (id >= 0 && (size_t)id < denseIndex.size() && denseIndex[id] != -1)
+		return adjlist[denseIndex[id]];
+	auto pidx = nameIndex.find(name);
+	if (pidx != nameIndex.end())
+		return adjlist[pidx->second];
 	return nullptr;
 }
 
@@ -119,24 +502,115 @@ string graph::mapResourceType(const string type) const
 	return type;
 }
 
+// topological rank of every node (Kahn on the CSR), used to order the worklists of scheduleAll
+void graph::rankNodes()
+{
+	topoRank.assign(vertex,0);
+	byRank.clear();
+	vector<int> indegree(vertex);
+	for (int v = 0; v < vertex; ++v)
+		if ((indegree[v] = predOffset[v+1] - predOffset[v]) == 0)
+			byRank.push_back(v);
+	for (int head = 0; head < (int)byRank.size(); ++head)
+	{
+		int v = byRank[head];
+		topoRank[v] = head;
+		for (int k = succOffset[v]; k < succOffset[v+1]; ++k)
+			if (--indegree[succList[k]] == 0)
+				byRank.push_back(succList[k]);
+	}
+	queued.assign(vertex,0);
+}
+
+// time frame propagation after placing a node:
+// the ASAP of the successors (ALAP of the predecessors) are tightened through a worklist,
+// which is a heap on the topological rank, so every node of the affected cone is expanded at most once,
+// and only after all its tightened predecessors (successors) have been
+// nodes whose bound does not change stop the propagation
+// returns the number of nodes touched (the placed node and those whose bound tightened)
+int graph::scheduleAll(VNode* const& node,int step) // mainly for FDS
+{
+	int* asap = ns.asap.data();
+	int* alap = ns.alap.data();
+	const int* delay = ns.delay.data();
+	const int* rank = topoRank.data();
+	int touched = 1;
+	node->cstep() = step;
+	node->setASAP(step);
+	node->setALAP(step);
+	if (trackFrames)
+		tightened.push_back(node->num);
+
+	// forward, smallest rank first
+	auto later = greater<int>();
+	frontier.push_back(rank[node->num]);
+	while (!frontier.empty())
+	{
+		pop_heap(frontier.begin(),frontier.end(),later);
+		int v = byRank[frontier.back()];
+		frontier.pop_back();
+		queued[v] = 0;
+		int finish = asap[v] + delay[v];
+		for (const int *p = succList.data() + succOffset[v], *e = succList.data() + succOffset[v+1]; p != e; ++p)
+			if (finish > asap[*p])
+			{
+				asap[*p] = finish;
+				touched++;
+				if (trackFrames)
+					tightened.push_back(*p);
+				if (!queued[*p])
+				{
+					queued[*p] = 1;
+					frontier.push_back(rank[*p]);
+					push_heap(frontier.begin(),frontier.end(),later);
+				}
+			}
+	}
+
+	// backward, largest rank first
+	frontier.push_back(rank[node->num]);
+	while (!frontier.empty())
+	{
+		pop_heap(frontier.begin(),frontier.end());
+		int v = byRank[frontier.back()];
+		frontier.pop_back();
+		queued[v] = 0;
+		for (const int *p = predList.data() + predOffset[v], *e = predList.data() + predOffset[v+1]; p != e; ++p)
+			if (alap[v] - delay[*p] < alap[*p])
+			{
+				alap[*p] = alap[v] - delay[*p];
+				touched++;
+				if (trackFrames)
+					tightened.push_back(*p);
+				if (!queued[*p])
+				{
+					queued[*p] = 1;
+					frontier.push_back(rank[*p]);
+					push_heap(frontier.begin(),frontier.end());
+				}
+			}
+	}
+	node->setLength();
+	numPropagation++;
+	numTouched += touched;
+	return touched;
+}
+
 bool graph::newScheduleNodeStep(VNode* const& node,int step)
 {
 	// cout << node->num << " " << step << endl;
-	if (step + node->delay - 1 > ConstrainedLatency) // important to minus 1
+	if (step + node->delay() - 1 > ConstrainedLatency) // important to minus 1
 	{
 		cout << "Invalid schedule!" << endl;
 		return false;
 	}
-	auto Rtype = mapResourceType(node->type);
-	for (int i = node->cstep; i < node->cstep + node->delay; ++i)
-		nrt[i][Rtype]--;
-	for (int i = step; i < step + node->delay; ++i)
-		nrt[i][Rtype]++;
-	maxNrt[Rtype] = 0;
-	for (auto x: nrt)
-		maxNrt[Rtype] = max(maxNrt[Rtype],x[Rtype]);
+	int r = node->rtype;
+	for (int i = node->cstep(); i < node->cstep() + node->delay(); ++i)
+		nrt.dec(i,r);
+	for (int i = step; i < step + node->delay(); ++i)
+		nrt.inc(i,r);
 	node->schedule(step);
-	maxLatency = max(maxLatency,step + node->delay - 1);
+	maxLatency = max(maxLatency,step + node->delay() - 1);
 	return true;
 }
 
@@ -146,59 +620,43 @@ bool graph::scheduleNodeStep(VNode* const& node,int step,int mode = 0)
 	{
 		// cout << node->num+1 << " " << step << endl;
 		for (auto pnode = node->succ.cbegin(); pnode != node->succ.cend(); ++pnode)
-			if ((*pnode)->cstep == 0 && max((*pnode)->asap,step + node->delay) > (*pnode)->alap)
+			if ((*pnode)->cstep() == 0 && max((*pnode)->asap(),step + node->delay()) > (*pnode)->alap())
 				return false;
 		for (auto pnode = node->pred.cbegin(); pnode != node->pred.cend(); ++pnode)
-			if ((*pnode)->cstep == 0 && min((*pnode)->alap,step - (*pnode)->delay) < (*pnode)->asap)
+			if ((*pnode)->cstep() == 0 && min((*pnode)->alap(),step - (*pnode)->delay()) < (*pnode)->asap())
 				return false;
 	}
-	if (step + node->delay - 1 > ConstrainedLatency) // important to minus 1
+	if (step + node->delay() - 1 > ConstrainedLatency) // important to minus 1
 	{
 		cout << "Invalid schedule!" << endl;
 		return false;
 	}
-	for (int i = step; i < step + node->delay; ++i)
-	{
-		nrt[i][mapResourceType(node->type)]++;
-		maxNrt[mapResourceType(node->type)] = max(maxNrt[mapResourceType(node->type)],nrt[i][mapResourceType(node->type)]);
-	}
+	for (int i = step; i < step + node->delay(); ++i)
+		nrt.inc(i,node->rtype);
 	switch (mode)
 	{
 		case 0: node->schedule(step);break;
 		case 1: node->scheduleBackward(step);break;
-		case 2: node->scheduleAll(step);break;
+		case 2: scheduleAll(node,step);break;
 		default: cout << "Invaild schedule mode!" << endl;return false;
 	}
-	maxLatency = max(maxLatency,step + node->delay - 1);
+	maxLatency = max(maxLatency,step + node->delay() - 1);
 	numScheduledOp++;
 	return true;
 }
 
 bool graph::scheduleNodeStepResource(VNode* const& node,int step,int mode = 0)
 {
-	for (int i = step; i < step + node->delay; ++i)
-	{
-		nrt[i][mapResourceType(node->type)]++;
-		maxNrt[mapResourceType(node->type)] = max(maxNrt[mapResourceType(node->type)],nrt[i][mapResourceType(node->type)]);
-	}
+	for (int i = step; i < step + node->delay(); ++i)
+		nrt.inc(i,node->rtype);
 	switch (mode)
 	{
 		case 0: node->schedule(step);break;
 		case 1: node->scheduleBackward(step);break;
-		case 2: node->scheduleAll(step);break;
+		case 2: scheduleAll(node,step);break;
 		default: cout << "Invaild schedule mode!" << endl;return false;
 	}
-	maxLatency = max(maxLatency,step + node->delay - 1); // important to minus 1
+	maxLatency = max(maxLatency,step + node->delay() - 1); // important to minus 1
 	numScheduledOp++;
 	return true;
-}
-
-std::vector<std::string> split(const std::string& input, const std::string& regex) // split the string
-{
-	// passing -1 as the submatch index parameter performs splitting
-	std::regex re(regex);
-	std::sregex_token_iterator
-		first{ input.begin(), input.end(), re, -1 },
-		last;
-	return { first, last };
 }
\ No newline at end of file
@@ -0,0 +1,211 @@
+// Copyright (c) 2018 Hongzheng Chen
+// E-mail: chenhzh37@mail2.sysu.edu.cn
+
+// This is the implementation of Entropy-directed scheduling (EDS) algorithm for FPGA high-level synthesis.
+
+// This file contains the benchmarks of the infrastructure (not the scheduling quality).
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <chrono> // timing
+#include <thread>
+
+using Clock = std::chrono::high_resolution_clock;
+
+#include "graph.h"
+#include "graph.hpp"
+using namespace std;
+
+const vector<string> dot_file = {
+	"",
+	"hal",
+	"horner_bezier_surf_dfg__12",
+	"arf",
+	"motion_vectors_dfg__7",
+	"ewf",
+	"fir2",
+	"fir1",
+	"h2v2_smooth_downsample_dfg__6",
+	"feedback_points_dfg__7",
+	"collapse_pyr_dfg__113",
+	"cosine1",
+	"cosine2",
+	"write_bmp_header_dfg__7",
+	"interpolate_aux_dfg__12",
+	"matmul_dfg__3",
+	"idctcol_dfg__3",
+	"jpeg_idct_ifast_dfg__5",
+	"jpeg_fdct_islow_dfg__6",
+	"smooth_color_z_triangle_dfg__31",
+	"invert_matrix_general_dfg__3",
+	"dag_500",
+	"dag_1000",
+	"dag_1500"
+};
+
+// if you need to load from other path, please modify here
+string path = "./Benchmarks/";
+
+// Time the graph loaders on every benchmark
+// each file is loaded `rep` times and the average is reported
+void benchLoad(int rep)
+{
+	const int K = 3;
+	const string loader[K] = {"ifstream","mmap","cache"};
+	long long total[K] = {0,0,0};
+	cout << "Load time (average of " << rep << " runs):" << endl;
+	cout << setw(34) << std::left << "";
+	for (int k = 0; k < K; ++k)
+		cout << setw(16) << loader[k];
+	cout << endl;
+	for (int file_num = 1; file_num < (int)dot_file.size(); ++file_num)
+	{
+		string file = path + dot_file[file_num] + ".dot";
+		long long sum[K] = {0,0,0};
+		for (int r = 0; r <= rep; ++r) // the first round only warms up the cache
+			for (int k = 0; k < K; ++k)
+			{
+				graph gp;
+				gp.setMODE(vector<int>{0,0});
+				gp.setPRINT(0);
+				gp.setCACHE(k == 2);
+				auto t1 = Clock::now();
+				bool ok = true;
+				if (k == 0)
+				{
+					ifstream infile(file);
+					if ((ok = bool(infile)))
+						gp.readFile(infile);
+				}
+				else
+					ok = gp.readFile(file.c_str());
+				auto t2 = Clock::now();
+				if (!ok)
+				{
+					cout << "Error: No such files!" << endl;
+					return;
+				}
+				if (r > 0)
+					sum[k] += std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+			}
+		cout << setw(34) << std::left << dot_file[file_num];
+		for (int k = 0; k < K; ++k)
+		{
+			cout << setw(16) << to_string(sum[k] / rep) + " ns";
+			total[k] += sum[k] / rep;
+		}
+		cout << endl;
+	}
+	cout << setw(34) << std::left << "Total";
+	for (int k = 0; k < K; ++k)
+		cout << setw(16) << to_string(total[k]) + " ns";
+	cout << endl;
+}
+
+// Time the topological sortings (with the time frames) on every benchmark
+// the graph is read once and reset before each run
+void benchTopo(int rep)
+{
+	const int K = 4;
+	int cores = max(1,(int)std::thread::hardware_concurrency());
+	const string sorting[K] = {"DFS","Kahn","level x1","level x" + to_string(cores)};
+	long long total[K] = {0,0,0,0};
+	cout << "Topological sorting time (average of " << rep << " runs):" << endl;
+	cout << setw(34) << std::left << "";
+	for (int k = 0; k < K; ++k)
+		cout << setw(16) << sorting[k];
+	cout << endl;
+	for (int file_num = 1; file_num < (int)dot_file.size(); ++file_num)
+	{
+		graph gp;
+		gp.setMODE(vector<int>{0,0});
+		gp.setPRINT(0);
+		if (!gp.readFile((path + dot_file[file_num] + ".dot").c_str()))
+		{
+			cout << "Error: No such files!" << endl;
+			return;
+		}
+		long long sum[K] = {0,0,0,0};
+		for (int r = 0; r <= rep; ++r) // the first round only warms up
+			for (int k = 0; k < K; ++k)
+			{
+				gp.resetSchedule();
+				auto t1 = Clock::now();
+				switch (k)
+				{
+					case 0: gp.topologicalSortingDFS();break;
+					case 1: gp.topologicalSortingKahn();break;
+					case 2: gp.topologicalSortingLevel(1);break;
+					case 3: gp.topologicalSortingLevel(cores);break;
+				}
+				auto t2 = Clock::now();
+				if (r > 0)
+					sum[k] += std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+			}
+		cout << setw(34) << std::left << dot_file[file_num];
+		for (int k = 0; k < K; ++k)
+		{
+			cout << setw(16) << to_string(sum[k] / rep) + " ns";
+			total[k] += sum[k] / rep;
+		}
+		cout << endl;
+	}
+	cout << setw(34) << std::left << "Total";
+	for (int k = 0; k < K; ++k)
+		cout << setw(16) << to_string(total[k]) + " ns";
+	cout << endl;
+}
+
+// Time reading and scheduling (RC_EDS) a chain of n operations
+// a chain is the deepest graph possible, which is what a recursive time frame computation cannot stand
+void benchChain(int n)
+{
+	string file = "./chain_" + to_string(n) + ".dot";
+	ofstream outfile(file);
+	outfile << "digraph chain {\n";
+	for (int i = 0; i < n; ++i)
+		outfile << "    " << i << " [label = add];\n";
+	for (int i = 0; i + 1 < n; ++i)
+		outfile << "    " << i << " -> " << i+1 << ";\n";
+	outfile << "}\n";
+	outfile.close();
+
+	graph gp;
+	gp.setMODE(vector<int>{10,0});
+	gp.setPRINT(0);
+	gp.setCACHE(0);
+	gp.setMAXRESOURCE(map<string,int>{{"add",1}});
+	auto t1 = Clock::now();
+	bool ok = gp.readFile(file.c_str());
+	auto t2 = Clock::now();
+	std::remove(file.c_str());
+	if (!ok)
+	{
+		cout << "Error: No such files!" << endl;
+		return;
+	}
+	cout << "Chain of " << n << " operations" << endl;
+	cout << "Read time: " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() << " ns" << endl;
+	gp.mainScheduling(1);
+}
+
+// argv[1] benchmark:
+//			load	time the graph loaders (ifstream, mmap, .edsg cache) on all the benchmarks
+//			topo	time the topological sortings (DFS, Kahn, level-parallel Kahn) on all the benchmarks
+//			chain	time reading and scheduling a chain of operations
+// argv[2] repetitions of load/topo (default 10), or the length of the chain (default 1000000)
+int main(int argc,char *argv[])
+{
+	string bench = (argc > 1 ? string(argv[1]) : "load");
+	if (bench == "load")
+		benchLoad(argc > 2 ? stoi(string(argv[2])) : 10);
+	else if (bench == "topo")
+		benchTopo(argc > 2 ? stoi(string(argv[2])) : 10);
+	else if (bench == "chain")
+		benchChain(argc > 2 ? stoi(string(argv[2])) : 1000000);
+	else
+		cout << "Error: No such benchmark!" << endl;
+	return 0;
+}
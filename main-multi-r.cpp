@@ -123,15 +123,7 @@ void interactive()
 			cout << file_num << ": " << dot_file[file_num] << endl;
 		int file_num;
 		cin >> file_num;
-		cout << "Begin reading dot file..." << endl;
-		ifstream infile(path + dot_file[file_num] + ".dot");
-		if (infile)
-			cout << "Read in dot file successfully!\n" << endl;
-		else
-		{
-			cout << "Error: No such files!" << endl;
-			return;
-		}
+		string infile = path + dot_file[file_num] + ".dot";
 	
 		graph gp;
 		vector<int> MODE;
@@ -156,7 +148,14 @@ void interactive()
 		cin >> mode;
 		MODE.push_back(mode);
 		gp.setMODE(MODE);
-		gp.readFile(infile);
+		cout << "Begin reading dot file..." << endl;
+		if (gp.readFile(infile.c_str()))
+			cout << "Read in dot file successfully!\n" << endl;
+		else
+		{
+			cout << "Error: No such files!" << endl;
+			return;
+		}
 
 		if (MODE[0] == 2)
 		{
@@ -182,8 +181,6 @@ void interactive()
 		}
 		else
 			gp.mainScheduling();
-	
-		infile.close();
 	}
 }
 
@@ -214,64 +211,63 @@ void commandline(char *argv[])
 		case 12: MODE.push_back(stoi(string(argv[1])));break;
 		default: cout << "Error: Mode wrong!" << endl;break;
 	}
-for (int a = 1; a < 20; ++a){
-	for (int b = 1; b < 20; ++b){
-		if (a < 8)
-			continue;
 	for (int file_num = 23; file_num < dot_file.size(); ++file_num)
 	{
-		ifstream infile(path + dot_file[file_num] + ".dot");
-		if (!infile)
-		{
-			cout << "Error: No such files!" << endl;
-			return;
-		}
-
+		// the graph is read once and rescheduled for every point of the sweep
 		graph gp;
 		gp.setMODE(MODE);
 		gp.setPRINT(0);
-		gp.readFile(infile);
-		if (MODE[0] >= 10){
-			// gp.setMAXRESOURCE(RC.at(file_num));
-			cout << a << " " << b << endl;
-			gp.setMAXRESOURCE(map<string,int>{{"MUL",a }, {"add",b}});
-		}
-		else
-			gp.setLC(stod(string(argv[2])));
-		if (MODE[0] == 2)
+		if (!gp.readFile((path + dot_file[file_num] + ".dot").c_str()))
 		{
-			try{
-				system("md TC_ILP");
-			}
-			catch(...){}
-			char str[10];
-			snprintf(str,sizeof(str),"%.1f",gp.getLC());
-			ofstream outfile("./TC_ILP/"+dot_file[file_num]+"_"+string(str)+".lp");
-			gp.generateTC_ILP(outfile);
-			outfile.close();
-		}
-		else if (MODE[0] == 12)
-		{
-			try{
-				system("md RC_ILP");
-			}
-			catch(...){}
-			ofstream outfile("./RC_ILP/"+dot_file[file_num]+".lp");
-			gp.generateRC_ILP(outfile);
-			outfile.close();
-		}
-		else
-		{
-			cout << "File # " << file_num << " (" << dot_file[file_num] << ") :" <<endl;
-			gp.mainScheduling(1);
+			cout << "Error: No such files!" << endl;
+			return;
 		}
+		for (int a = 1; a < 20; ++a)
+			for (int b = 1; b < 20; ++b)
+			{
+				if (a < 8)
+					continue;
+				gp.resetSchedule();
+				if (MODE[0] >= 10)
+				{
+					// gp.setMAXRESOURCE(RC.at(file_num));
+					cout << a << " " << b << endl;
+					gp.setMAXRESOURCE(map<string,int>{{"MUL",a }, {"add",b}});
+				}
+				else
+					gp.setLC(stod(string(argv[2])));
+				if (MODE[0] == 2)
+				{
+					try{
+						system("md TC_ILP");
+					}
+					catch(...){}
+					char str[10];
+					snprintf(str,sizeof(str),"%.1f",gp.getLC());
+					ofstream outfile("./TC_ILP/"+dot_file[file_num]+"_"+string(str)+".lp");
+					gp.generateTC_ILP(outfile);
+					outfile.close();
+				}
+				else if (MODE[0] == 12)
+				{
+					try{
+						system("md RC_ILP");
+					}
+					catch(...){}
+					ofstream outfile("./RC_ILP/"+dot_file[file_num]+".lp");
+					gp.generateRC_ILP(outfile);
+					outfile.close();
+				}
+				else
+				{
+					cout << "File # " << file_num << " (" << dot_file[file_num] << ") :" <<endl;
+					gp.mainScheduling(1);
+				}
 
-		infile.close();
-
-		ofstream outfile("./r.r",ios::app);
-		outfile << a << " " << b << " " << gp.getMaxLatency() << "\n";
+				ofstream outfile("./r.r",ios::app);
+				outfile << a << " " << b << " " << gp.getMaxLatency() << "\n";
+			}
 	}
-}}
 }
 
 int main(int argc,char *argv[])
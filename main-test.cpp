@@ -0,0 +1,568 @@
+// Copyright (c) 2018 Hongzheng Chen
+// E-mail: chenhzh37@mail2.sysu.edu.cn
+
+// This is the implementation of Entropy-directed scheduling (EDS) algorithm for FPGA high-level synthesis.
+
+// This file contains the regression tests of the schedulers (built with the sanitizers by `make check`).
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <functional>
+#include <cstdlib>
+#include <chrono> // timing
+
+using Clock = std::chrono::high_resolution_clock;
+
+#include "graph.h"
+#include "graph.hpp"
+using namespace std;
+
+const vector<string> dot_file = {
+	"",
+	"hal",
+	"horner_bezier_surf_dfg__12",
+	"arf",
+	"motion_vectors_dfg__7",
+	"ewf",
+	"fir2",
+	"fir1",
+	"h2v2_smooth_downsample_dfg__6",
+	"feedback_points_dfg__7",
+	"collapse_pyr_dfg__113",
+	"cosine1",
+	"cosine2",
+	"write_bmp_header_dfg__7",
+	"interpolate_aux_dfg__12",
+	"matmul_dfg__3",
+	"idctcol_dfg__3",
+	"jpeg_idct_ifast_dfg__5",
+	"jpeg_fdct_islow_dfg__6",
+	"smooth_color_z_triangle_dfg__31",
+	"invert_matrix_general_dfg__3",
+	"dag_500",
+	"dag_1000",
+	"dag_1500"
+};
+
+// if you need to load from other path, please modify here
+string path = "./Benchmarks/";
+
+// a tiny graph of two weakly connected components (ExPRESS format), the expected results are
+// the ones of the baseline (regex parser, DFS order) unless stated
+const string tiny_dot =
+	"digraph tiny {\n"
+	"    node [fontcolor=white,style=filled,color=\"160,60,176\"];\n"
+	"    1 [label = mul];\n    2 [label = mul];\n    3 [label = mul];\n    4 [label = sub];\n"
+	"    5 [label = sub];\n    6 [label = mul];\n    7 [label = add];\n    8 [label = add];\n"
+	"    9 [label = mul];\n    10 [label = add];\n    11 [label = add];\n    12 [label = mul];\n"
+	"    13 [label = sub];\n"
+	"    1 -> 3 [name = 1];\n    2 -> 3 [name = 2];\n    3 -> 4 [name = 3];\n    4 -> 5 [name = 4];\n"
+	"    6 -> 7 [name = 5];\n    7 -> 5 [name = 6];\n    2 -> 8 [name = 7];\n    9 -> 10 [name = 8];\n"
+	"    10 -> 11 [name = 9];\n    12 -> 11 [name = 10];\n    11 -> 13 [name = 11];\n"
+	"}\n";
+
+const string tiny_adjlist =
+	"Adjacent list:\n"
+	"[ Format: node num ( node name ) : successor num ( successor name ) ]\n"
+	"1( 1 ): 3( 3 ) \n2( 2 ): 3( 3 ) 8( 8 ) \n3( 3 ): 4( 4 ) \n4( 4 ): 5( 5 ) \n5( 5 ): \n"
+	"6( 6 ): 7( 7 ) \n7( 7 ): 5( 5 ) \n8( 8 ): \n9( 9 ): 10( 10 ) \n10( 10 ): 11( 11 ) \n"
+	"11( 11 ): 13( 13 ) \n12( 12 ): 11( 11 ) \n13( 13 ): \n";
+
+void writeFile(const string& file,const string& text)
+{
+	ofstream outfile(file,ios::binary);
+	outfile << text;
+}
+
+// what f prints on cout
+string captured(const function<void()>& f)
+{
+	stringstream out;
+	streambuf* old = cout.rdbuf(out.rdbuf());
+	f();
+	cout.rdbuf(old);
+	return out.str();
+}
+
+bool report(const string& name,bool ok)
+{
+	cout << name << ": " << (ok ? "passed" : "FAILED") << endl;
+	return ok;
+}
+
+// the adjacency list of a graph read from file
+string adjacency(const string& file,bool stream,bool cache = false)
+{
+	graph gp;
+	gp.setMODE(vector<int>{0,0});
+	gp.setPRINT(0);
+	gp.setCACHE(cache);
+	if (stream)
+	{
+		ifstream infile(file,ios::binary);
+		gp.readFile(infile);
+	}
+	else if (!gp.readFile(file.c_str()))
+		return "";
+	return captured([&gp]() { gp.printAdjlist(); });
+}
+
+// the DOT tokenizer gives the graph of the baseline parser, through the mapping and the stream,
+// also with the syntax the baseline could not read (comments, quoted names, chains, attributes on many lines)
+bool testParser()
+{
+	string file = "./test_parser.dot";
+	writeFile(file,tiny_dot);
+	bool ok = report("mmap",adjacency(file,false) == tiny_adjlist);
+	ok = report("ifstream",adjacency(file,true) == tiny_adjlist) && ok;
+	writeFile(file,
+		"/* the tiny graph */ strict digraph \"tiny\" { node [shape = circle];\n"
+		"  1 [label = mul]; 2 [label=\"mul\"]\n  3 [\n    label = mul,\n    color = red\n  ];\n"
+		"  4 [label = sub]; 5 [label = sub]; // sinks\n"
+		"  \"6\" [label = mul]; 7 [label = add]; 8 [label = add]; 9 [label = mul]; 10 [label = add];\n"
+		"# a line to skip\n"
+		"  11 [label = add]; 12 [label = mul]; 13 [label = sub];\n"
+		"  1 -> 3; 2 -> 3 -> 4 -> 5 [name = 2];\n  6 -> \"7\" -> 5;\n  2->8\n"
+		"  9 -> 10 -> 11 -> 13; 12 -> 11 [weight = 1, name = 10];\n"
+		"}\n");
+	ok = report("DOT syntax",adjacency(file,false) == tiny_adjlist) && ok;
+	std::remove(file.c_str());
+	return ok;
+}
+
+// reads file through the cache: the adjacency list, the TC_EDS schedule (LC 1.5), and whether the cache was hit
+string cachedRead(const string& file,int order,vector<int>& schedule,bool& hit)
+{
+	graph gp;
+	gp.setMODE(vector<int>{0,order});
+	gp.setLC(1.5);
+	string log = captured([&]() { gp.readFile(file.c_str()); });
+	hit = (log.find("Loaded graph cache successfully!") != string::npos);
+	string adj = captured([&gp]() { gp.printAdjlist(); });
+	gp.setPRINT(0);
+	captured([&gp]() { gp.TC_EDS(0); });
+	schedule = gp.getSchedule();
+	return adj;
+}
+
+// the .edsg cache gives the graph and the schedules of a cold parse (also in the other order),
+// and a corrupt, truncated or stale cache is rejected, i.e. the dot file is parsed again
+bool testCache()
+{
+	string file = "./test_cache.dot", cache = "./test_cache.edsg";
+	writeFile(file,tiny_dot);
+	std::remove(cache.c_str());
+	vector<int> cold, warm, coldBU, warmBU;
+	bool hit, ok = true;
+	ok = report("cold parse",cachedRead(file,0,cold,hit) == tiny_adjlist && !hit) && ok;
+	ok = report("cache hit",cachedRead(file,0,warm,hit) == tiny_adjlist && hit && warm == cold) && ok;
+	string adjBU;
+	{
+		graph gp; // bottom-up without the cache
+		gp.setMODE(vector<int>{0,1});
+		gp.setLC(1.5);
+		gp.setPRINT(0);
+		gp.setCACHE(0);
+		gp.readFile(file.c_str());
+		adjBU = captured([&gp]() { gp.printAdjlist(); });
+		captured([&gp]() { gp.TC_EDS(0); });
+		coldBU = gp.getSchedule();
+	}
+	ok = report("cache hit (bottom-up)",cachedRead(file,1,warmBU,hit) == adjBU && hit && warmBU == coldBU) && ok;
+
+	// flip a byte of the node names (the last bytes of the file)
+	string image;
+	{
+		ifstream infile(cache,ios::binary);
+		image.assign(istreambuf_iterator<char>(infile),istreambuf_iterator<char>());
+	}
+	string bad = image;
+	bad[bad.size() - 2] ^= 1;
+	writeFile(cache,bad);
+	ok = report("corrupt cache",cachedRead(file,0,warm,hit) == tiny_adjlist && !hit && warm == cold) && ok;
+	writeFile(cache,image.substr(0,image.size() / 2));
+	ok = report("truncated cache",cachedRead(file,0,warm,hit) == tiny_adjlist && !hit && warm == cold) && ok;
+	ok = report("rewritten cache",cachedRead(file,0,warm,hit) == tiny_adjlist && hit) && ok;
+
+	// one more edge in the dot file
+	string dot = tiny_dot;
+	dot.insert(dot.rfind('}'),"    8 -> 13 [name = 12];\n");
+	writeFile(file,dot);
+	string adj = cachedRead(file,0,warm,hit);
+	ok = report("stale cache",!hit && adj.find("8( 8 ): 13( 13 ) \n") != string::npos) && ok;
+	std::remove(file.c_str());
+	std::remove(cache.c_str());
+	return ok;
+}
+
+// the time frames (LC 1.0) after one of the topological sortings: 0 DFS, 1 Kahn (FIFO), 2 level-parallel Kahn
+// with threads, empty if the order is not topological
+string timeFrames(const string& file,int sorting,int threads = 1)
+{
+	graph gp;
+	gp.setMODE(vector<int>{0,0});
+	gp.setLC(1.0);
+	gp.setPRINT(0);
+	gp.setCACHE(0);
+	if (!gp.readFile(file.c_str()))
+		return "";
+	switch (sorting)
+	{
+		case 0: gp.topologicalSortingDFS();break;
+		case 1: gp.topologicalSortingKahn();break;
+		case 2: gp.topologicalSortingLevel(threads);break;
+	}
+	if (!gp.testTopologicalOrder())
+		return "";
+	return captured([&gp]() { gp.printTimeFrame(); });
+}
+
+// Kahn's sorting and its level-parallel variant give a topological order
+// and the time frames of the DFS sorting (the baseline), on the tiny graph and on the benchmarks
+bool testTopo()
+{
+	string file = "./test_topo.dot";
+	writeFile(file,tiny_dot);
+	const string frames = "Time frame:\n1: [ 1 , 1 ]\n2: [ 1 , 1 ]\n3: [ 3 , 3 ]\n4: [ 5 , 5 ]\n5: [ 6 , 6 ]\n"
+		"6: [ 1 , 3 ]\n7: [ 3 , 5 ]\n8: [ 3 , 6 ]\n9: [ 1 , 2 ]\n10: [ 3 , 4 ]\n11: [ 4 , 5 ]\n12: [ 1 , 3 ]\n13: [ 5 , 6 ]\n";
+	bool ok = report("tiny DFS",timeFrames(file,0) == frames);
+	ok = report("tiny Kahn",timeFrames(file,1) == frames) && ok;
+	ok = report("tiny level-parallel",timeFrames(file,2,2) == frames) && ok;
+	std::remove(file.c_str());
+	for (int file_num = 1; file_num < (int)dot_file.size(); ++file_num)
+	{
+		file = path + dot_file[file_num] + ".dot";
+		string dfs = timeFrames(file,0);
+		ok = report(dot_file[file_num],!dfs.empty() && timeFrames(file,1) == dfs
+			&& timeFrames(file,2,1) == dfs && timeFrames(file,2,4) == dfs) && ok;
+	}
+	return ok;
+}
+
+// one EDS run on file: MODE {mode,order}, LC 1.5 for TC, the resources of the tiny graph (and of hal) for RC,
+// the portfolio of variants for mode 5 or 15 (order_mode is then unused)
+// gives (resources, latency) for TC, (latency, resources) for RC, (-1,-1) if the schedule is infeasible
+pair<int,int> runEDS(const string& file,int mode,int order,int order_mode,int variants = 0,vector<int>* schedule = nullptr)
+{
+	graph gp;
+	gp.setMODE(vector<int>{mode,order});
+	gp.setLC(1.5);
+	gp.setMAXRESOURCE({{"MUL",2},{"add",1},{"sub",1},{"les",1}});
+	gp.setPRINT(0);
+	gp.setCACHE(0);
+	gp.setPortfolio(variants,1);
+	if (!gp.readFile(file.c_str()))
+		return make_pair(-1,-1);
+	captured([&]()
+		{
+			if (mode % 10 == 5)
+				gp.portfolioEDS();
+			else if (mode >= 10)
+				gp.RC_EDS(order_mode);
+			else
+				gp.TC_EDS(order_mode);
+		});
+	if (!gp.testFeasibleSchedule())
+		return make_pair(-1,-1);
+	if (schedule != nullptr)
+		*schedule = gp.getSchedule();
+	if (mode >= 10)
+		return make_pair(gp.getMaxLatency(),gp.getTotalResources());
+	return make_pair(gp.getTotalResources(),gp.getMaxLatency());
+}
+
+// the portfolio keeps a schedule at least as good as every variant without random ties (both directions,
+// DFS, ALAP-sorted and ASAP-sorted orders), and a portfolio of one is TC_EDS of the baseline
+bool checkPortfolio(const string& name,const string& file,int mode)
+{
+	auto best = runEDS(file,mode + 5,0,0,10);
+	bool ok = (best.first >= 0);
+	for (int order = 0; order < 2; ++order)
+		for (int order_mode = 0; order_mode < 3; ++order_mode)
+		{
+			auto variant = runEDS(file,mode,order,order_mode);
+			ok = ok && variant.first >= 0 && best <= variant;
+		}
+	return report(name + (mode >= 10 ? " (RC)" : " (TC)"),ok);
+}
+
+bool testPortfolio()
+{
+	string file = "./test_portfolio.dot";
+	writeFile(file,tiny_dot);
+	vector<int> schedule;
+	bool ok = report("tiny variant 0",runEDS(file,5,0,0,1,&schedule).second == 9
+		&& schedule == vector<int>{1,3,5,7,9,6,8,5,1,3,6,3,8});
+	ok = checkPortfolio("tiny",file,0) && ok;
+	ok = checkPortfolio("tiny",file,10) && ok;
+	std::remove(file.c_str());
+	for (int file_num : {1,9,21})
+		ok = checkPortfolio(dot_file[file_num],path + dot_file[file_num] + ".dot",0) && ok;
+	ok = checkPortfolio(dot_file[1],path + dot_file[1] + ".dot",10) && ok;
+	return ok;
+}
+
+// the steps used by every type of the tiny graph (mul of delay 2, add, sub) in a schedule
+map<string,vector<int>> tinyUsage(const vector<int>& schedule)
+{
+	const vector<string> type = {"mul","mul","mul","sub","sub","mul","add","add","mul","add","add","mul","sub"};
+	map<string,vector<int>> usage;
+	for (size_t v = 0; v < type.size(); ++v)
+		for (int t = schedule[v]; t < schedule[v] + (type[v] == "mul" ? 2 : 1); ++t)
+		{
+			vector<int>& u = usage[type[v]];
+			if (t >= (int)u.size())
+				u.resize(t + 1,0);
+			u[t]++;
+		}
+	return usage;
+}
+
+// RC scheduling of file (MODE {mode,0}) as a whole or split into its components,
+// the schedule, its latency and what is printed
+string splitRun(const string& file,int mode,bool split,vector<int>& schedule,int& latency)
+{
+	graph gp;
+	gp.setMODE(vector<int>{mode,0});
+	gp.setMAXRESOURCE({{"MUL",2},{"add",1},{"sub",1}});
+	gp.setPRINT(0);
+	gp.setCACHE(0);
+	gp.setSPLIT(split);
+	gp.readFile(file.c_str());
+	string log = captured([&gp]() { gp.mainScheduling(1); });
+	schedule = gp.getSchedule();
+	latency = gp.getMaxLatency();
+	return log;
+}
+
+// the components of the tiny graph scheduled on their own and merged: a feasible schedule within the constraints
+// for RC EDS, IEDS, FDS and LS, and for EDS no longer than the baseline (latency 9);
+// the other modes and a connected graph are scheduled as a whole, with a message
+bool testSplit()
+{
+	string file = "./test_split.dot";
+	writeFile(file,tiny_dot);
+	const map<string,int> bound = {{"mul",2},{"add",1},{"sub",1}};
+	vector<int> schedule;
+	int latency;
+	bool ok = true;
+	for (int mode : {10,11,13,14})
+	{
+		string log = splitRun(file,mode,true,schedule,latency);
+		bool fits = (log.find("Infeasible") == string::npos);
+		for (auto& u : tinyUsage(schedule))
+			for (auto n : u.second)
+				fits = fits && n <= bound.at(u.first);
+		ok = report("tiny split (mode " + to_string(mode) + ")",fits && (mode != 10 || latency <= 9)) && ok;
+	}
+	ok = report("other mode",splitRun(file,15,true,schedule,latency).find("scheduled as a whole") != string::npos) && ok;
+	writeFile(file,
+		"digraph line {\n    1 [label = mul];\n    2 [label = add];\n    3 [label = sub];\n"
+		"    1 -> 2 [name = 1];\n    2 -> 3 [name = 2];\n}\n");
+	vector<int> whole;
+	splitRun(file,10,false,whole,latency);
+	ok = report("connected graph",splitRun(file,10,true,schedule,latency).find("scheduled as a whole") != string::npos
+		&& schedule == whole) && ok;
+	std::remove(file.c_str());
+	return ok;
+}
+
+// TC_FDS (LC 1.5) with the cross-checks on: what is printed, the schedule, and whether it is feasible in time
+string checkedFDS(const string& file,int threads,vector<int>& schedule,bool& ok)
+{
+	graph gp;
+	gp.setMODE(vector<int>{3,0});
+	gp.setLC(1.5);
+	gp.setPRINT(0);
+	gp.setCACHE(0);
+	gp.setCHECK(1);
+	gp.readFile(file.c_str());
+	bool placed = false;
+	string log = captured([&]() { placed = gp.TC_FDS(threads); });
+	schedule = gp.getSchedule();
+	ok = placed && gp.testFeasibleSchedule() && gp.getMaxLatency() <= gp.getConstrainedLatency();
+	return log;
+}
+
+// every candidate TC_FDS takes from its heap has the least force of all (as the full sort of the baseline would find),
+// the entries and DG are exact, and the schedule is feasible and the same with 1 and 4 threads
+// (the baseline itself is no reference: it truncated the forces to int)
+bool testFDS()
+{
+	string file = "./test_fds.dot";
+	writeFile(file,tiny_dot);
+	vector<string> files = {file};
+	for (int file_num : {1,11,13})
+		files.push_back(path + dot_file[file_num] + ".dot");
+	bool ok = true;
+	for (auto& f : files)
+	{
+		vector<int> one, four;
+		bool feasible1, feasible4;
+		string log = checkedFDS(f,1,one,feasible1) + checkedFDS(f,4,four,feasible4);
+		bool exact = (log.find("Not the least") == string::npos && log.find("out of date") == string::npos
+			&& log.find("mismatch") == string::npos);
+		ok = report(f == file ? "tiny" : f.substr(path.size(),f.size() - path.size() - 4),exact && feasible1 && feasible4 && one == four) && ok;
+	}
+	std::remove(file.c_str());
+	return ok;
+}
+
+// list scheduling of file with a priority policy (comparePriorities for mode 6 or 16), MODE {mode,0},
+// LC 1.0 for TC, the resources of the tiny graph for RC
+// gives (resources, latency) for TC, (latency, resources) for RC, (-1,-1) if the schedule is infeasible
+// (or out of the latency constraint for TC)
+template <class Priority>
+pair<int,int> runLS(const string& file,int mode,vector<int>* schedule = nullptr)
+{
+	graph gp;
+	gp.setMODE(vector<int>{mode,0});
+	gp.setLC(1.0);
+	gp.setMAXRESOURCE({{"MUL",2},{"add",1},{"sub",1},{"les",1}});
+	gp.setPRINT(0);
+	gp.setCACHE(0);
+	if (!gp.readFile(file.c_str()))
+		return make_pair(-1,-1);
+	captured([&]()
+		{
+			if (mode % 10 == 6)
+				gp.comparePriorities();
+			else if (mode >= 10)
+				gp.RC_LS<Priority>();
+			else
+				gp.TC_LS<Priority>();
+		});
+	if (!gp.testFeasibleSchedule() || (mode < 10 && gp.getMaxLatency() > gp.getConstrainedLatency()))
+		return make_pair(-1,-1);
+	if (schedule != nullptr)
+		*schedule = gp.getSchedule();
+	if (mode >= 10)
+		return make_pair(gp.getMaxLatency(),gp.getTotalResources());
+	return make_pair(gp.getTotalResources(),gp.getMaxLatency());
+}
+
+// every priority policy gives a feasible schedule, and comparePriorities keeps the best of them
+bool checkPolicies(const string& name,const string& file,int mode)
+{
+	vector<pair<int,int>> score = {runLS<ALAPPriority>(file,mode),runLS<MobilityPriority>(file,mode),
+		runLS<PathPriority>(file,mode),runLS<SuccessorPriority>(file,mode),runLS<ForcePriority>(file,mode)};
+	bool ok = true;
+	for (auto& sc : score)
+		ok = ok && sc.first >= 0;
+	return report(name + (mode >= 10 ? " (RC)" : " (TC)"),
+		ok && runLS<ALAPPriority>(file,mode + 2) == *min_element(score.begin(),score.end()));
+}
+
+// TC_LS and RC_LS with every priority policy: the default TC_LS of the tiny graph needs no more resources
+// than the baseline one (ties broken by the DFS order), RC_LS keeps the constraints
+bool testLS()
+{
+	string file = "./test_ls.dot";
+	writeFile(file,tiny_dot);
+	auto peaks = [](const vector<int>& schedule)
+		{
+			int sum_r = 0;
+			for (auto& u : tinyUsage(schedule))
+				sum_r += *max_element(u.second.begin(),u.second.end());
+			return sum_r;
+		};
+	vector<int> schedule;
+	auto tc = runLS<ALAPPriority>(file,4,&schedule);
+	bool ok = report("tiny TC_LS",tc.first >= 0 && tc.first == peaks(schedule)
+		&& tc.first <= peaks(vector<int>{1,1,3,5,6,1,4,6,1,3,5,3,6}));
+	auto rc = runLS<ALAPPriority>(file,14,&schedule);
+	bool fits = (rc.first >= 0);
+	const map<string,int> bound = {{"mul",2},{"add",1},{"sub",1}};
+	for (auto& u : tinyUsage(schedule))
+		for (auto n : u.second)
+			fits = fits && n <= bound.at(u.first);
+	ok = report("tiny RC_LS",fits) && ok;
+	ok = checkPolicies("tiny",file,4) && ok;
+	ok = checkPolicies("tiny",file,14) && ok;
+	std::remove(file.c_str());
+	for (int file_num : {1,9,13})
+		ok = checkPolicies(dot_file[file_num],path + dot_file[file_num] + ".dot",4) && ok;
+	ok = checkPolicies(dot_file[1],path + dot_file[1] + ".dot",14) && ok;
+	return ok;
+}
+
+// TC_IEDS at LC 1.0 must give a valid schedule within the latency constraint
+bool checkIEDS(const string& name,const string& file)
+{
+	graph gp;
+	gp.setMODE(vector<int>{1,0});
+	gp.setPRINT(0);
+	gp.setCACHE(0);
+	gp.setLC(1.0);
+	if (!gp.readFile(file.c_str()))
+	{
+		cout << "Error: No such files!" << endl;
+		return false;
+	}
+	gp.TC_IEDS(0);
+	return report(name,gp.testFeasibleSchedule() && gp.getMaxLatency() <= gp.getConstrainedLatency());
+}
+
+// IEDS fine-tuning with a delay-2 type (MUL) at LC 1.0, i.e. the MUL ops reach the last steps of N_r(t)
+// a small graph whose MUL ops have some slack, then all the benchmarks
+bool testIEDS()
+{
+	string file = "./test_ieds.dot";
+	ofstream outfile(file);
+	outfile << "digraph test_ieds {\n";
+	for (int i = 0; i < 4; ++i)
+		outfile << "    " << i << " [label = add];\n";
+	for (int i = 4; i < 7; ++i)
+		outfile << "    " << i << " [label = MUL];\n";
+	outfile << "    0 -> 1;\n    1 -> 2;\n    2 -> 3;\n    0 -> 4;\n    0 -> 5;\n    5 -> 6;\n";
+	outfile << "}\n";
+	outfile.close();
+	bool ok = checkIEDS("test_ieds",file);
+	std::remove(file.c_str());
+	for (int file_num = 1; file_num < (int)dot_file.size(); ++file_num)
+		ok = checkIEDS(dot_file[file_num],path + dot_file[file_num] + ".dot") && ok;
+	return ok;
+}
+
+// the tests in the order they run, argv[1] (default all) runs only one of them:
+//			parser	the DOT tokenizer against the baseline parser
+//			cache	the .edsg cache against the dot file, and its rejection when stale or broken
+//			topo	Kahn's and the level-parallel sortings against the DFS one
+//			ieds	TC_IEDS at LC 1.0 with a delay-2 type
+//			portfolio	the EDS portfolio against its variants
+//			split	the weakly connected components scheduled on their own and merged
+//			fds		the TC_FDS candidate heap against a full scan
+//			ls		the priority policies of TC_LS and RC_LS
+const vector<pair<string,function<bool()>>> tests = {
+	{"parser",testParser},
+	{"cache",testCache},
+	{"topo",testTopo},
+	{"ieds",testIEDS},
+	{"portfolio",testPortfolio},
+	{"split",testSplit},
+	{"fds",testFDS},
+	{"ls",testLS}
+};
+
+// returns 1 if a test fails
+int main(int argc,char *argv[])
+{
+	string test = (argc > 1 ? string(argv[1]) : "all");
+	bool ok = true, known = false;
+	for (auto& t : tests)
+		if (test == t.first || test == "all")
+		{
+			known = true;
+			cout << "Test " << t.first << ":" << endl;
+			ok = t.second() && ok;
+		}
+	if (!known)
+	{
+		cout << "Error: No such test!" << endl;
+		return 1;
+	}
+	cout << (ok ? "All tests passed." : "Some tests FAILED.") << endl;
+	return (ok ? 0 : 1);
+}
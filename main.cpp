@@ -123,21 +123,13 @@ void interactive()
 			cout << file_num << ": " << dot_file[file_num] << endl;
 		int file_num;
 		cin >> file_num;
-		cout << "Begin reading dot file..." << endl;
-		ifstream infile(path + dot_file[file_num] + ".dot");
-		if (infile)
-			cout << "Read in dot file successfully!\n" << endl;
-		else
-		{
-			cout << "Error: No such files!" << endl;
-			return;
-		}
+		string infile = path + dot_file[file_num] + ".dot";
 	
 		graph gp;
 		vector<int> MODE;
 		cout << "\nPlease enter the scheduling mode:" << endl;
-		cout << "Time-constrained(TC):\t0  EDS\t1  IEDS\t2  ILP\t3  FDS\t4  LS" << endl;
-		cout << "Resource-constrained(RC):\t10 EDS\t11 IEDS\t12 ILP\t13 FDS\t 14 LS" << endl;
+		cout << "Time-constrained(TC):\t0  EDS\t1  IEDS\t2  ILP\t3  FDS\t4  LS\t5  EDS portfolio\t6  LS priorities" << endl;
+		cout << "Resource-constrained(RC):\t10 EDS\t11 IEDS\t12 ILP\t13 FDS\t 14 LS\t15 EDS portfolio\t16 LS priorities" << endl;
 		int mode;
 		cin >> mode;
 		MODE.push_back(mode);
@@ -156,7 +148,14 @@ void interactive()
 		cin >> mode;
 		MODE.push_back(mode);
 		gp.setMODE(MODE);
-		gp.readFile(infile);
+		cout << "Begin reading dot file..." << endl;
+		if (gp.readFile(infile.c_str()))
+			cout << "Read in dot file successfully!\n" << endl;
+		else
+		{
+			cout << "Error: No such files!" << endl;
+			return;
+		}
 
 		if (MODE[0] == 2)
 		{
@@ -182,20 +181,20 @@ void interactive()
 		}
 		else
 			gp.mainScheduling();
-	
-		infile.close();
 	}
 }
 
 // set these argv from cmd
 // argv[0] default file path: needn't give
 // argv[1] scheduling mode:
-// 			time-constrained(TC):		0  EDS    1  IEDS    2  ILP    3  FDS   4  LS
-//			resource-constrained(RC):	10 EDS    11 IEDS    12 ILP    13 FDS   14 LS
+// 			time-constrained(TC):		0  EDS    1  IEDS    2  ILP    3  FDS   4  LS   5  EDS portfolio   6  LS priorities
+//			resource-constrained(RC):	10 EDS    11 IEDS    12 ILP    13 FDS   14 LS   15 EDS portfolio   16 LS priorities
 // ****** If the arguments below are not needed, you needn't type anything more. ******
 // argv[2] latency factor (LC) or scheduling order
 //                                0 top-down  1 bottom-up
-void commandline(char *argv[])
+// argv[3] (RC EDS, IEDS, FDS, LS) 1 to schedule the weakly connected components on their own and merge them
+//                                (ignored, with a message, for the other modes and the connected graphs)
+void commandline(int argc,char *argv[])
 {
 	vector<int> MODE;
 	MODE.push_back(stoi(string(argv[1]))); // scheduling mode
@@ -204,11 +203,15 @@ void commandline(char *argv[])
 		case 0:
 		case 1:
 		case 3:
-		case 4: MODE.push_back(stoi(string(argv[3])));break;
+		case 4:
+		case 5:
+		case 6: MODE.push_back(stoi(string(argv[3])));break;
 		case 10:
 		case 11:
 		case 13:
-		case 14: MODE.push_back(stoi(string(argv[2])));break;
+		case 14:
+		case 15:
+		case 16: MODE.push_back(stoi(string(argv[2])));break;
 		case 2: MODE.push_back(stoi(string(argv[2])));break;
 		case 12: MODE.push_back(stoi(string(argv[1])));break;
 		default: cout << "Error: Mode wrong!" << endl;break;
@@ -216,17 +219,16 @@ void commandline(char *argv[])
 
 	for (int file_num = 1; file_num < dot_file.size(); ++file_num)
 	{
-		ifstream infile(path + dot_file[file_num] + ".dot");
-		if (!infile)
+		graph gp;
+		gp.setMODE(MODE);
+		gp.setPRINT(0);
+		if (MODE[0] >= 10 && argc > 3)
+			gp.setSPLIT(stoi(string(argv[3])));
+		if (!gp.readFile((path + dot_file[file_num] + ".dot").c_str()))
 		{
 			cout << "Error: No such files!" << endl;
 			return;
 		}
-
-		graph gp;
-		gp.setMODE(MODE);
-		gp.setPRINT(0);
-		gp.readFile(infile);
 		if (MODE[0] >= 10)
 			gp.setMAXRESOURCE(RC.at(file_num));
 		else
@@ -258,8 +260,6 @@ void commandline(char *argv[])
 			cout << "File # " << file_num << " (" << dot_file[file_num] << ") :" <<endl;
 			gp.mainScheduling(1);
 		}
-
-		infile.close();
 	}
 }
 
@@ -268,7 +268,7 @@ int main(int argc,char *argv[])
 	if (argc == 1) // interactive
 		interactive();
 	else // read from cmd
-		commandline(argv);
+		commandline(argc,argv);
 	return 0;
 }
 
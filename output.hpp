@@ -23,11 +23,11 @@ void graph::printAdjlist() const
 
 void graph::countEachStepResource() const
 {
-	for (auto ptype = nr.crbegin(); ptype != nr.crend(); ++ptype)
+	for (int r = typeNum - 1; r >= 0; --r)
 	{
-		cout << mapResourceType(ptype->first) << ": ";
+		cout << typeName[r] << ": ";
 		for (int i = 1; i <= maxLatency; ++i) // ConstrainedLatency
-			cout << nrt[i].at(mapResourceType(ptype->first)) << " ";
+			cout << nrt[i][r] << " ";
 		cout << endl;
 	}
 }
@@ -36,11 +36,11 @@ void graph::countResource() const
 {
 	int sum_r = 0;
 	ofstream out("./Resource_"+to_string(LC)+".out",ios::app);
-	for (auto ptype = nr.crbegin(); ptype != nr.crend(); ++ptype)
+	for (int r = typeNum - 1; r >= 0; --r)
 	{
-		cout << ptype->first << ": " << maxNrt.at(ptype->first) << endl;
-		out << maxNrt.at(ptype->first) << " ";
-		sum_r += maxNrt.at(ptype->first);
+		cout << typeName[r] << ": " << nrt.peak[r] << endl;
+		out << nrt.peak[r] << " ";
+		sum_r += nrt.peak[r];
 		if (PRINT)
 			countEachStepResource();
 	}
@@ -66,7 +66,7 @@ void graph::standardOutput() const
 		printTimeFrame();
 	cout << "Final schedule:" << endl;
 	for (int i = 0; i < vertex; ++i)
-		cout << i+1 << ": " << adjlist[i]->cstep << ((i+1)%5==0 ? "\n" : "\t");
+		cout << i+1 << ": " << adjlist[i]->cstep() << ((i+1)%5==0 ? "\n" : "\t");
 	cout << endl;
 	printGanttGraph();
 	cout << "Total latency: " << maxLatency << endl;
@@ -106,10 +106,10 @@ void graph::printGanttGraph() const
 	for (int i = 0; i < vertex; ++i)
 	{
 		cout << setw(4) << std::left << i+1;
-		for (int j = 1; j < adjlist[i]->cstep; ++j)
+		for (int j = 1; j < adjlist[i]->cstep(); ++j)
 			cout << " ";
-		for (int j = 1; j <= adjlist[i]->delay; ++j)
-			cout << (adjlist[i]->delay > 1 ? "X" : "O");
+		for (int j = 1; j <= adjlist[i]->delay(); ++j)
+			cout << (adjlist[i]->delay() > 1 ? "X" : "O");
 		cout << endl;
 	}
 }
@@ -119,7 +119,7 @@ bool graph::testFeasibleSchedule() const
 	int flag = 0;
 	for (int i = 0; i < vertex; ++i)
 		for (auto pnode = adjlist[i]->succ.cbegin(); pnode != adjlist[i]->succ.cend(); ++pnode)
-			if (adjlist[i]->cstep + adjlist[i]->delay - 1 >= (*pnode)->cstep)
+			if (adjlist[i]->cstep() + adjlist[i]->delay() - 1 >= (*pnode)->cstep())
 			{
 				flag = 1;
 				cout << "Schedule conflicts with Node " << adjlist[i]->num+1 << " (" << adjlist[i]->name << ") "
@@ -131,6 +131,25 @@ bool graph::testFeasibleSchedule() const
 		return true;
 }
 
+// every node is in order exactly once, after all its predecessors
+bool graph::testTopologicalOrder() const
+{
+	if ((int)order.size() != vertex)
+		return false;
+	vector<int> pos(vertex,-1);
+	for (int i = 0; i < vertex; ++i)
+	{
+		if (pos[order[i]->num] != -1)
+			return false;
+		pos[order[i]->num] = i;
+	}
+	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
+		for (auto psucc = (*pnode)->succ.cbegin(); psucc != (*pnode)->succ.cend(); ++psucc)
+			if (pos[(*pnode)->num] >= pos[(*psucc)->num])
+				return false;
+	return true;
+}
+
 void graph::print(const string str) const
 {
 	if (PRINT)
@@ -139,19 +158,21 @@ void graph::print(const string str) const
 
 void graph::countTF()
 {
-	for (auto pnr = nr.cbegin(); pnr != nr.cend(); ++pnr)
+	TFcount.assign(typeNum,vector<int>(ConstrainedLatency+1,0));
+	const int* asap = ns.asap.data();
+	const int* alap = ns.alap.data();
+	const int* delay = ns.delay.data();
+	for (int v = 0; v < vertex; ++v)
 	{
-		vector<int> tnr(ConstrainedLatency+1,0);
-		TFcount[pnr->first] = tnr;
+		vector<int>& tf = TFcount[adjlist[v]->rtype];
+		for (int i = asap[v]; i < alap[v] + delay[v]; ++i)
+			tf[i] += 1;
 	}
-	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
-		for (int i = (*pnode)->asap; i < (*pnode)->alap + (*pnode)->delay; ++i)
-			TFcount[mapResourceType((*pnode)->type)][i] += 1;
-	// for (auto pnr = nr.crbegin(); pnr != nr.crend(); ++pnr)
+	// for (int r = typeNum - 1; r >= 0; --r)
 	// {
-	// 	cout << mapResourceType(pnr->first) << ": ";
+	// 	cout << typeName[r] << ": ";
 	// 	for (int i = 1; i <= ConstrainedLatency; ++i) // ConstrainedLatency
-	// 		cout << (TFcount.at(mapResourceType(pnr->first)))[i] << " ";
+	// 		cout << TFcount[r][i] << " ";
 	// 	cout << endl;
 	// }
 }
@@ -161,5 +182,5 @@ void graph::printTimeFrame() const // need to be printed before scheduling
 	cout << "Time frame:" << endl;
 	int cnt = 1;
 	for (auto pnode : adjlist)
-		cout << pnode->num+1 << ": [ " << pnode->asap << " , " << pnode->alap << " ]" << endl;
+		cout << pnode->num+1 << ": [ " << pnode->asap() << " , " << pnode->alap() << " ]" << endl;
 }
\ No newline at end of file
@@ -5,47 +5,90 @@
 
 // This file contains the implementation of the topological sorting.
 
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+#include <tuple>
+
 void graph::setDegrees()
 {
 	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
 		(*pnode)->tempIncoming = (*pnode)->incoming = (*pnode)->pred.size();
 }
 
-void graph::dfsASAP(VNode* const& node)
+// both passes are post-order DFS with an explicit stack (node, next neighbour to visit),
+// so deep graphs cannot overflow the call stack
+// they give the same order and time frames as the former recursive version
+void graph::dfsASAP(VNode* const& root)
 {
-	if (mark[node->num])
+	if (mark[root->num])
 		return;
-	if (!(node->pred.empty()))
-		for (auto pprec = node->pred.cbegin(); pprec != node->pred.cend(); ++pprec)
+	dfsStack.push_back(make_pair(root,0));
+	while (!dfsStack.empty())
+	{
+		VNode* node = dfsStack.back().first;
+		int& next = dfsStack.back().second;
+		if (next < node->pred.size())
 		{
-			dfsASAP(*pprec);
-			node->setASAP((*pprec)->asap + (*pprec)->delay);
+			VNode* pprec = node->pred[next++];
+			if (!mark[pprec->num])
+				dfsStack.push_back(make_pair(pprec,0));
+			continue;
 		}
-	cdepth = max(node->asap + node->delay - 1,cdepth); // critical path delay
+		// all the predecessors are done
+		for (auto pprec = node->pred.cbegin(); pprec != node->pred.cend(); ++pprec)
+			node->setASAP((*pprec)->asap() + (*pprec)->delay());
+		cdepth = max(node->asap() + node->delay() - 1,cdepth); // critical path delay
+		mark[node->num] = 1;
+		order.push_back(node);
+		dfsStack.pop_back();
+	}
+	setLatencyConstraint();
+}
+
+void graph::setLatencyConstraint()
+{
 	if (MODE[0] < 10 || MODE[0] == 13)
 		setConstrainedLatency(int(cdepth*LC));
 	else
 		setConstrainedLatency(MAXINT_);
-	mark[node->num] = 1;
-	order.push_back(node);
 }
 
-void graph::dfsALAP(VNode* const& node) // different from asap
+// ALAP of a node whose successors are all done
+inline void graph::pullALAP(VNode* const& node)
 {
-	if (mark[node->num])
-		return;
 	if (node->succ.empty())
-		node->setALAP(ConstrainedLatency - node->delay + 1); // ConstrainedLatency is used here, dfsasap must be done first
+		node->setALAP(ConstrainedLatency - node->delay() + 1);
 	else for (auto psucc = node->succ.cbegin(); psucc != node->succ.cend(); ++psucc)
+		node->setALAP((*psucc)->alap() - node->delay());
+	node->setLength();
+}
+
+void graph::dfsALAP(VNode* const& root) // different from asap
+{
+	if (mark[root->num])
+		return;
+	dfsStack.push_back(make_pair(root,0));
+	while (!dfsStack.empty())
 	{
-		dfsALAP(*psucc);
-		node->setALAP((*psucc)->alap - node->delay);
+		VNode* node = dfsStack.back().first;
+		int& next = dfsStack.back().second;
+		if (next < node->succ.size())
+		{
+			VNode* psucc = node->succ[next++];
+			if (!mark[psucc->num])
+				dfsStack.push_back(make_pair(psucc,0));
+			continue;
+		}
+		pullALAP(node); // ConstrainedLatency is used here, dfsasap must be done first
+		mark[node->num] = 1;
+		dfsStack.pop_back();
 	}
-	node->setLength();
-	mark[node->num] = 1;
 }
 
-void graph::topologicalSortingDFS(bool aslap_order)
+void graph::topologicalSortingDFS(int order_mode)
 {
 	setDegrees();
 	print("Begin topological sorting...");
@@ -59,52 +102,166 @@ void graph::topologicalSortingDFS(bool aslap_order)
 		if ((*pnode)->pred.empty() && !mark[(*pnode)->num]) // in-degree = 0
 			dfsALAP(*pnode);
 	// regenerate order
-	if (aslap_order)
+	if (order_mode == 1)
 		sort(order.begin(),order.end(),[](VNode* const& node1,VNode* const& node2)
 			{
-				if (node1->alap < node2->alap)
+				if (node1->alap() < node2->alap())
 					return true;
-				else if (node1->alap == node2->alap)
-						if (node1->asap < node2->asap)
+				else if (node1->alap() == node2->alap())
+						if (node1->asap() < node2->asap())
 							return true;
 						else
 							return false;
 					else
 						return false;
 			});
+	else if (order_mode == 2) // ASAP-sorted, the ties keep the DFS order
+		stable_sort(order.begin(),order.end(),[](VNode* const& node1,VNode* const& node2)
+			{ return node1->asap() < node2->asap(); });
+	// seeded random tie-breaks: the order is sorted by ASAP (by ALAP & ASAP for order_mode 1) and the ties are shuffled
+	// both keys increase along every edge, so the order stays topological
+	if (tieSeed != 0)
+	{
+		mt19937 gen(tieSeed);
+		vector<unsigned> key(vertex);
+		for (auto& k : key)
+			k = gen();
+		if (order_mode == 1)
+			sort(order.begin(),order.end(),[&key](VNode* const& node1,VNode* const& node2)
+				{ return make_tuple(node1->alap(),node1->asap(),key[node1->num]) < make_tuple(node2->alap(),node2->asap(),key[node2->num]); });
+		else
+			sort(order.begin(),order.end(),[&key](VNode* const& node1,VNode* const& node2)
+				{ return make_pair(node1->asap(),key[node1->num]) < make_pair(node2->asap(),key[node2->num]); });
+	}
 	print("Topological sorting done!");
 	// printTimeFrame();
 }
 
+// Kahn's algorithm with a FIFO queue, the time frames are computed in the same pass
+// order itself is the queue: order[head..] are the ready nodes not yet expanded
 void graph::topologicalSortingKahn()
 {
 	print("Begin topological sorting (Kahn)...");
-	// -------- DFS part --------
-	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode) // asap
-		if ((*pnode)->succ.empty() && !mark[(*pnode)->num]) // out-degree = 0
-			dfsASAP(*pnode);
-	clearMark();
-	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode) // alap
-		if ((*pnode)->pred.empty() && !mark[(*pnode)->num]) // in-degree = 0
-			dfsALAP(*pnode);
-	// --------------------------
-	order.clear();
-	vector<VNode*> temp;
 	setDegrees();
+	order.clear();
 	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
 		if ((*pnode)->pred.empty()) // in-degree = 0
-			temp.push_back(*pnode);
-	while (!temp.empty())
+			order.push_back(*pnode);
+	for (int head = 0; head < (int)order.size(); ++head)
 	{
-		order.push_back(temp[0]);
-		for (auto pnode = temp[0]->succ.cbegin(); pnode != temp[0]->succ.cend(); ++pnode)
+		VNode* node = order[head];
+		cdepth = max(node->asap() + node->delay() - 1,cdepth); // critical path delay
+		for (auto pnode = node->succ.cbegin(); pnode != node->succ.cend(); ++pnode)
 		{
-			(*pnode)->tempIncoming--;
-			if ((*pnode)->tempIncoming == 0)
-				temp.push_back(*pnode);
+			(*pnode)->setASAP(node->asap() + node->delay());
+			if (--(*pnode)->tempIncoming == 0)
+				order.push_back(*pnode);
 		}
-		temp.erase(temp.begin());
 	}
+	setLatencyConstraint();
+	for (auto pnode = order.crbegin(); pnode != order.crend(); ++pnode) // alap
+		pullALAP(*pnode);
 	print("Topological sorting (Kahn) done!");
 	clearMark();
-}
\ No newline at end of file
+}
+
+// reusable barrier for the level-synchronous sorting
+struct LevelBarrier
+{
+	std::mutex m;
+	std::condition_variable cv;
+	int count, waiting = 0, generation = 0;
+	LevelBarrier(int _count): count(_count){};
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(m);
+		int gen = generation;
+		if (++waiting == count)
+		{
+			waiting = 0;
+			generation++;
+			cv.notify_all();
+		}
+		else
+			cv.wait(lock,[this,gen]{ return gen != generation; });
+	}
+};
+
+// level-synchronous Kahn: the nodes of a frontier (level) are split across the threads,
+// each one pulls the ASAP of its nodes from their finished predecessors
+// and decrements the in-degrees of their successors atomically
+// the next frontier is sorted by node number, so the order does not depend on the threads
+// ALAP is then pulled level by level in reverse order
+void graph::topologicalSortingLevel(int threads)
+{
+	print("Begin topological sorting (level-parallel Kahn)...");
+	if (threads <= 0)
+		threads = max(1,(int)std::thread::hardware_concurrency());
+	order.clear();
+	vector<std::atomic<int>> indegree(vertex);
+	for (auto pnode = adjlist.cbegin(); pnode != adjlist.cend(); ++pnode)
+	{
+		indegree[(*pnode)->num].store((*pnode)->pred.size(),std::memory_order_relaxed);
+		if ((*pnode)->pred.empty())
+			order.push_back(*pnode);
+	}
+	vector<int> level(1,0); // order[level[i] .. level[i+1]) is the i-th frontier
+	vector<vector<VNode*>> next(threads);
+	vector<int> depth(threads,0);
+	LevelBarrier barrier(threads);
+	auto work = [&](int id)
+		{
+			// forward: ASAP and the frontiers
+			for (int l = 0; level[l] < (int)order.size(); ++l)
+			{
+				int lo = level[l], hi = order.size(), chunk = (hi - lo + threads - 1) / threads;
+				for (int i = lo + id * chunk; i < min(hi,lo + (id + 1) * chunk); ++i)
+				{
+					VNode* node = order[i];
+					for (auto pprec = node->pred.cbegin(); pprec != node->pred.cend(); ++pprec)
+						node->setASAP((*pprec)->asap() + (*pprec)->delay());
+					depth[id] = max(depth[id],node->asap() + node->delay() - 1);
+					for (auto psucc = node->succ.cbegin(); psucc != node->succ.cend(); ++psucc)
+						if (indegree[(*psucc)->num].fetch_sub(1,std::memory_order_acq_rel) == 1)
+							next[id].push_back(*psucc);
+				}
+				barrier.wait();
+				if (id == 0)
+				{
+					level.push_back(order.size());
+					int size = order.size();
+					for (int t = 0; t < threads; ++t)
+					{
+						order.insert(order.end(),next[t].begin(),next[t].end());
+						next[t].clear();
+					}
+					sort(order.begin() + size,order.end(),
+						[](VNode* const& v1,VNode* const& v2){ return v1->num < v2->num; });
+				}
+				barrier.wait();
+			}
+			if (id == 0)
+			{
+				cdepth = max(cdepth,*max_element(depth.begin(),depth.end()));
+				setLatencyConstraint();
+			}
+			barrier.wait();
+			// backward: ALAP
+			for (int l = (int)level.size() - 2; l >= 0; --l)
+			{
+				int lo = level[l], hi = level[l+1], chunk = (hi - lo + threads - 1) / threads;
+				for (int i = lo + id * chunk; i < min(hi,lo + (id + 1) * chunk); ++i)
+					pullALAP(order[i]);
+				barrier.wait();
+			}
+		};
+	vector<std::thread> pool;
+	for (int t = 1; t < threads; ++t)
+		pool.push_back(std::thread(work,t));
+	work(0);
+	for (auto& th : pool)
+		th.join();
+	setDegrees();
+	print("Topological sorting (level-parallel Kahn) done!");
+	clearMark();
+}